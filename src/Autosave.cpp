@@ -0,0 +1,127 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#include "Autosave.h"
+
+#include <iostream>
+#include <utility>
+
+
+Autosave::Autosave(const std::string& filename, Clock::duration interval):
+    mFilename(filename),
+    mInterval(interval),
+    mNextSave(Clock::now() + interval),
+    mSpare(std::make_unique<SavedCity>()),
+    mThread(&Autosave::run, this)
+{}
+
+
+/**
+ * Finishes writing any waiting save before returning.
+ */
+Autosave::~Autosave()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mExit = true;
+    }
+
+    mStateChanged.notify_all();
+    mThread.join();
+}
+
+
+/**
+ * Call from the simulation thread between steps. Only the copy
+ * happens here, the file is written on the worker thread.
+ */
+void Autosave::save(const CityProperties& properties, const Budget& budget)
+{
+    mNextSave = Clock::now() + mInterval;
+
+    std::unique_ptr<SavedCity> city;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        city = std::move(mSpare);
+    }
+
+    if (!city)
+    {
+        city = std::make_unique<SavedCity>();
+    }
+
+    captureCity(*city, properties, budget);
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mSpare = std::move(mPending);
+        mPending = std::move(city);
+    }
+
+    mStateChanged.notify_all();
+}
+
+
+void Autosave::run()
+{
+    std::unique_ptr<SavedCity> city;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+
+            // Hand the last written buffer back for reuse.
+            if (city && !mSpare)
+            {
+                mSpare = std::move(city);
+            }
+
+            mStateChanged.wait(lock, [this] { return mExit || mPending; });
+
+            if (!mPending)
+            {
+                return;
+            }
+
+            city = std::move(mPending);
+        }
+
+        write(*city);
+    }
+}
+
+
+/**
+ * Appends a delta when there's a full save to build on, otherwise
+ * writes the whole city. A failed append is followed by a full save.
+ */
+void Autosave::write(const SavedCity& city)
+{
+    if (mBase && mDeltaCount < DeltasBeforeCompaction)
+    {
+        if (appendCityDelta(mFilename, *mBase, city))
+        {
+            ++mDeltaCount;
+            return;
+        }
+    }
+
+    mBase.reset();
+
+    if (!writeCity(mFilename, city))
+    {
+        std::cout << "Unable to autosave the city to the file named '" << mFilename << "'" << std::endl;
+        return;
+    }
+
+    mBase = std::make_unique<TileMap>(city.map);
+    mDeltaCount = 0;
+}
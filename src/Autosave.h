@@ -0,0 +1,76 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#pragma once
+
+#include "s_fileio.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class Budget;
+class CityProperties;
+
+
+/**
+ * Periodically saves the city without holding up the simulation.
+ *
+ * \c save() copies the city into a spare buffer at a tick boundary
+ * and hands it to a worker thread which writes it out. If a save
+ * is still being written the newest copy replaces any waiting one.
+ *
+ * The first save writes the whole city. Later ones append a delta
+ * holding only the parts of the map changed since then, and every
+ * so often the file is compacted by writing the whole city again.
+ */
+class Autosave
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	Autosave() = delete;
+	Autosave(const Autosave&) = delete;
+	const Autosave& operator=(const Autosave&) = delete;
+
+	Autosave(const std::string& filename, Clock::duration interval);
+	~Autosave();
+
+	bool due() const { return Clock::now() >= mNextSave; }
+
+	void save(const CityProperties&, const Budget&);
+
+private:
+	static constexpr int DeltasBeforeCompaction{ 12 };
+
+	void run();
+	void write(const SavedCity&);
+
+	const std::string mFilename;
+	const Clock::duration mInterval;
+	Clock::time_point mNextSave;
+
+	std::unique_ptr<SavedCity> mSpare;
+	std::unique_ptr<SavedCity> mPending;
+
+	// Only touched by the worker thread.
+	std::unique_ptr<TileMap> mBase;
+	int mDeltaCount{ 0 };
+
+	std::mutex mMutex;
+	std::condition_variable mStateChanged;
+
+	bool mExit{ false };
+
+	std::thread mThread;
+};
@@ -0,0 +1,314 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#include "BudgetAdvisor.h"
+
+#include "Budget.h"
+#include "CityProperties.h"
+#include "Evaluation.h"
+
+#include "main.h"
+
+#include "s_msg.h"
+#include "s_sim.h"
+
+#include "w_sound.h"
+#include "w_util.h"
+
+#include <algorithm>
+#include <string>
+
+
+namespace
+{
+    constexpr int YearLength{ 48 }; // in CityTime
+
+
+    BudgetAdvisor::Distribution distribution(const std::vector<int>& values)
+    {
+        if (values.empty())
+        {
+            return {};
+        }
+
+        long long total{ 0 };
+        for (const auto value : values)
+        {
+            total += value;
+        }
+
+        const auto range = std::minmax_element(values.begin(), values.end());
+        return { *range.first, static_cast<int>(total / static_cast<long long>(values.size())), *range.second };
+    }
+
+
+    std::string percent(const float value)
+    {
+        return std::to_string(static_cast<int>(value * 100.0f + 0.5f)) + "%";
+    }
+
+
+    std::string distributionString(const BudgetAdvisor::Distribution& distribution)
+    {
+        return std::to_string(distribution.mean) + " (" + std::to_string(distribution.low) + ".." + std::to_string(distribution.high) + ")";
+    }
+};
+
+
+BudgetAdvisor::BudgetAdvisor(std::size_t runs, int years):
+    mRuns(runs > 0 ? runs : 1),
+    mYears(years > 0 ? years : 1),
+    mCity(std::make_unique<SimulationClone>()),
+    mRun(std::make_unique<SimulationClone>()),
+    mLive(std::make_unique<SimulationClone>())
+{}
+
+
+/**
+ * Starts working out advice for \c settings from the city as it is
+ * now. Returns false, without starting, while a phase is part way
+ * through.
+ */
+bool BudgetAdvisor::start(const std::vector<Setting>& settings, CityProperties& properties, Budget& budget)
+{
+    if (!cloneSimulation(*mCity, properties, budget))
+    {
+        return false;
+    }
+
+    // The seeds are drawn from the city's generator, which is put back
+    // so asking for advice doesn't change how the city goes on.
+    const auto random = RandomState();
+
+    mSeeds.clear();
+    for (std::size_t i = 0; i < mRuns; ++i)
+    {
+        mSeeds.push_back(RandomStreamSeed());
+    }
+
+    RandomState(random);
+
+    mSettings = settings;
+    mOutcomes.clear();
+    mPopulation.clear();
+    mFunds.clear();
+    mScore.clear();
+
+    mRunIndex = 0;
+    mRunStarted = false;
+    mRunning = !mSettings.empty();
+
+    return true;
+}
+
+
+/**
+ * Runs advice for about \c slice, or until \c giveWay returns true,
+ * and puts the live city back exactly as it was. Returns true once
+ * every run is done. Returns false, and does nothing, while a phase
+ * of the live city is part way through or \c giveWay already holds.
+ */
+bool BudgetAdvisor::advance(std::chrono::microseconds slice, CityProperties& properties, Budget& budget, const std::function<bool()>& giveWay)
+{
+    if (!mRunning)
+    {
+        return true;
+    }
+
+    const auto mustGiveWay = [&giveWay]() { return giveWay && giveWay(); };
+
+    if (mustGiveWay())
+    {
+        return false;
+    }
+
+    mWaitingForLiveCity = !cloneSimulation(*mLive, properties, budget);
+    if (mWaitingForLiveCity)
+    {
+        return false;
+    }
+
+    // Runs are silent and leave the message bar alone.
+    const bool sound = userSoundOn();
+    const std::string message = LastMessage();
+    const int messageTime = LastMessageTime();
+    const NotificationId messageId = MessageId();
+    const Point<int> messageLocation = MessageLocation();
+    userSoundOn(false);
+
+    const auto frameBudget = simulationFrameBudget();
+    simulationFrameBudget(std::chrono::microseconds::zero());
+
+    if (mRunStarted)
+    {
+        restoreSimulation(*mRun, properties, budget);
+    }
+    else
+    {
+        beginRun(properties, budget);
+    }
+
+    const auto sliceStart = std::chrono::steady_clock::now();
+    do
+    {
+        SimFrame(properties, budget);
+        scoreDoer(properties);
+
+        if (CityTime > mRunEnd)
+        {
+            endRun(budget);
+
+            if (!mRunning)
+            {
+                break;
+            }
+
+            beginRun(properties, budget);
+        }
+    }
+    while ((std::chrono::steady_clock::now() - sliceStart < slice) && !mustGiveWay());
+
+    if (mRunning)
+    {
+        cloneSimulation(*mRun, properties, budget);
+    }
+
+    restoreSimulation(*mLive, properties, budget);
+
+    simulationFrameBudget(frameBudget);
+
+    userSoundOn(sound);
+    LastMessage(message);
+    LastMessageTime(messageTime);
+    MessageId(messageId);
+    MessageLocation(messageLocation);
+
+    return !mRunning;
+}
+
+
+/**
+ * Drops advice being worked out, e.g. when another city is loaded.
+ */
+void BudgetAdvisor::cancel()
+{
+    mRunning = false;
+    mRunStarted = false;
+}
+
+
+/**
+ * Every outcome of the last advice, one setting a line, after a line
+ * saying what was tried.
+ */
+std::vector<std::string> BudgetAdvisor::report() const
+{
+    std::vector<std::string> lines
+    {
+        "Budget advice: " + std::to_string(mRuns) + " runs of " + std::to_string(mYears) + (mYears == 1 ? " year" : " years") +
+        " for each setting, mean (lowest..highest)"
+    };
+
+    for (const auto& outcome : mOutcomes)
+    {
+        const auto& setting = outcome.setting;
+        lines.push_back("Tax " + std::to_string(setting.taxRate) + "%"
+            + ", road " + percent(setting.roadPercent)
+            + ", police " + percent(setting.policePercent)
+            + ", fire " + percent(setting.firePercent)
+            + ": population " + distributionString(outcome.population)
+            + ", funds " + distributionString(outcome.funds)
+            + ", score " + distributionString(outcome.score));
+    }
+
+    return lines;
+}
+
+
+/**
+ * Tax rates either side of the one in \c budget, each with the
+ * current funding and with everything fully funded.
+ */
+std::vector<BudgetAdvisor::Setting> BudgetAdvisor::settingsAround(const Budget& budget)
+{
+    const Setting current{ budget.TaxRate(), budget.RoadPercent(), budget.PolicePercent(), budget.FirePercent() };
+    const bool fullyFunded = current.roadPercent == 1.0f && current.policePercent == 1.0f && current.firePercent == 1.0f;
+
+    std::vector<Setting> settings;
+    for (int offset = -2; offset <= 2; ++offset)
+    {
+        const int taxRate = current.taxRate + offset;
+        if (taxRate < Budget::MinTaxRate || taxRate > Budget::MaxTaxRate)
+        {
+            continue;
+        }
+
+        settings.push_back({ taxRate, current.roadPercent, current.policePercent, current.firePercent });
+
+        if (!fullyFunded)
+        {
+            settings.push_back({ taxRate, 1.0f, 1.0f, 1.0f });
+        }
+    }
+
+    return settings;
+}
+
+
+/**
+ * Starts the next run from the clone with its setting and seed, to
+ * go on for the advisor's number of years and end after the
+ * evaluation at the last year.
+ */
+void BudgetAdvisor::beginRun(CityProperties& properties, Budget& budget)
+{
+    const auto& setting = mSettings[mRunIndex / mSeeds.size()];
+
+    restoreSimulation(*mCity, properties, budget);
+
+    budget.TaxRate(setting.taxRate);
+    budget.RoadPercent(setting.roadPercent);
+    budget.PolicePercent(setting.policePercent);
+    budget.FirePercent(setting.firePercent);
+
+    SeedRandom(mSeeds[mRunIndex % mSeeds.size()]);
+
+    if (Paused())
+    {
+        SimSpeed(SimulationSpeed::Normal);
+    }
+
+    mRunEnd = (CityTime / YearLength + mYears) * YearLength;
+    mRunStarted = true;
+}
+
+
+/**
+ * Keeps how the run turned out and moves on to the next one.
+ */
+void BudgetAdvisor::endRun(const Budget& budget)
+{
+    mPopulation.push_back(cityPopulation());
+    mFunds.push_back(budget.CurrentFunds());
+    mScore.push_back(cityScore());
+
+    if (mPopulation.size() == mSeeds.size())
+    {
+        mOutcomes.push_back({ mSettings[mRunIndex / mSeeds.size()], distribution(mPopulation), distribution(mFunds), distribution(mScore) });
+
+        mPopulation.clear();
+        mFunds.clear();
+        mScore.clear();
+    }
+
+    ++mRunIndex;
+    mRunStarted = false;
+    mRunning = mRunIndex < runCount();
+}
@@ -0,0 +1,117 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#pragma once
+
+#include "s_sim.h"
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+class Budget;
+class CityProperties;
+
+
+/**
+ * Tries budget settings out on copies of the running city.
+ *
+ * Each setting is run several times from a clone of the city, each
+ * run with its own random seed, for a number of years. The same
+ * seeds are used for every setting so the settings are compared on
+ * the same luck. The city is put back exactly as it was afterwards.
+ *
+ * Runs are made one after another on the simulation thread, not in
+ * parallel. The simulation only runs on its globals, so a run is
+ * stepped by swapping it in for the live city, see SimulationClone.
+ * Advice is worked out a slice at a time in the time the live city
+ * leaves idle between its steps. Each slice swaps the live city out
+ * for the run in progress, simulates that until the slice is up or
+ * the live city is due again, and swaps the live city back in. Each
+ * run splits its map scans across the simulation thread pool when
+ * parallel simulation is on.
+ */
+class BudgetAdvisor
+{
+public:
+	struct Setting
+	{
+		int taxRate{};
+		float roadPercent{};
+		float policePercent{};
+		float firePercent{};
+	};
+
+	struct Distribution
+	{
+		int low{};
+		int mean{};
+		int high{};
+	};
+
+	struct Outcome
+	{
+		Setting setting{};
+		Distribution population{};
+		Distribution funds{};
+		Distribution score{};
+	};
+
+	BudgetAdvisor() = delete;
+	BudgetAdvisor(const BudgetAdvisor&) = delete;
+	const BudgetAdvisor& operator=(const BudgetAdvisor&) = delete;
+
+	BudgetAdvisor(std::size_t runs, int years);
+
+	bool start(const std::vector<Setting>& settings, CityProperties&, Budget&);
+	bool advance(std::chrono::microseconds slice, CityProperties&, Budget&, const std::function<bool()>& giveWay = {});
+	void cancel();
+
+	bool running() const { return mRunning; }
+	bool waitingForLiveCity() const { return mWaitingForLiveCity; } // a phase of the live city was part way through
+
+	std::size_t runsDone() const { return mRunIndex; }
+	std::size_t runCount() const { return mSettings.size() * mSeeds.size(); }
+
+	const std::vector<Outcome>& outcomes() const { return mOutcomes; }
+	std::vector<std::string> report() const;
+
+	static std::vector<Setting> settingsAround(const Budget&);
+
+private:
+	void beginRun(CityProperties&, Budget&);
+	void endRun(const Budget&);
+
+	const std::size_t mRuns;
+	const int mYears;
+
+	std::unique_ptr<SimulationClone> mCity; // the city as it was when advice was asked for
+	std::unique_ptr<SimulationClone> mRun; // the run in progress, between slices
+	std::unique_ptr<SimulationClone> mLive; // the live city, during a slice
+
+	std::vector<Setting> mSettings;
+	std::vector<std::mt19937::result_type> mSeeds;
+
+	std::size_t mRunIndex{ 0 };
+	int mRunEnd{ 0 };
+	bool mRunStarted{ false };
+	bool mRunning{ false };
+	bool mWaitingForLiveCity{ false };
+
+	std::vector<int> mPopulation;
+	std::vector<int> mFunds;
+	std::vector<int> mScore;
+
+	std::vector<Outcome> mOutcomes;
+};
@@ -0,0 +1,57 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+
+namespace Census
+{
+	/**
+	 * Census counters, in the order given by censusCounters().
+	 */
+	enum Counter : std::size_t
+	{
+		PoweredZones,
+		UnpoweredZones,
+		Fires,
+		Roads,
+		Rails,
+		Residential,
+		Commercial,
+		Industrial,
+		ResidentialZones,
+		CommercialZones,
+		IndustrialZones,
+		Hospitals,
+		Churches,
+		Stadiums,
+		PoliceStations,
+		FireStations,
+		CoalPlants,
+		NuclearPlants,
+		Seaports,
+		Airports
+	};
+};
+
+
+constexpr std::size_t CensusCounterCount{ 20 };
+
+/**
+ * What one part of the map adds to each census counter, indexed by
+ * Census::Counter.
+ */
+using CensusCounts = std::array<int, CensusCounterCount>;
+
+std::array<int*, CensusCounterCount> censusCounters();
+CensusCounts& censusTally();
@@ -0,0 +1,371 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#include "CityFile.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+
+namespace
+{
+    constexpr std::array<std::uint32_t, 256> CrcTable = []()
+    {
+        std::array<std::uint32_t, 256> table{};
+        for (std::uint32_t i = 0; i < 256; ++i)
+        {
+            std::uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+            }
+            table[i] = crc;
+        }
+        return table;
+    }();
+
+
+    void write16(std::ostream& stream, const std::uint16_t value)
+    {
+        const char bytes[2]{ static_cast<char>(value & 0xff), static_cast<char>(value >> 8) };
+        stream.write(bytes, sizeof(bytes));
+    }
+
+
+    void write32(std::ostream& stream, const std::uint32_t value)
+    {
+        write16(stream, static_cast<std::uint16_t>(value & 0xffff));
+        write16(stream, static_cast<std::uint16_t>(value >> 16));
+    }
+
+
+    std::uint16_t read16(std::istream& stream)
+    {
+        unsigned char bytes[2]{};
+        stream.read(reinterpret_cast<char*>(bytes), sizeof(bytes));
+        return static_cast<std::uint16_t>(bytes[0] | (bytes[1] << 8));
+    }
+
+
+    std::uint32_t read32(std::istream& stream)
+    {
+        const std::uint32_t low = read16(stream);
+        return low | (static_cast<std::uint32_t>(read16(stream)) << 16);
+    }
+
+
+    /**
+     * Bytes left to read in \c stream, or as many as could ever be
+     * there if it can't seek.
+     */
+    std::uint64_t bytesLeft(std::istream& stream)
+    {
+        const auto position = stream.tellg();
+        if (position < 0)
+        {
+            return std::numeric_limits<std::uint64_t>::max();
+        }
+
+        stream.seekg(0, std::ios::end);
+        const auto end = stream.tellg();
+        stream.seekg(position);
+
+        return (end > position) ? static_cast<std::uint64_t>(end - position) : 0;
+    }
+
+
+    std::uint16_t wordAt(const std::vector<std::uint8_t>& bytes, const std::size_t index)
+    {
+        return static_cast<std::uint16_t>(bytes[index * 2] | (bytes[(index * 2) + 1] << 8));
+    }
+
+
+    template<typename WordAt>
+    std::vector<std::uint8_t> compressRuns(const std::size_t wordCount, WordAt wordAt)
+    {
+        CityFile::ChunkData runs;
+
+        std::size_t i = 0;
+        while (i < wordCount)
+        {
+            const std::uint16_t word = wordAt(i);
+
+            std::size_t length = 1;
+            while ((i + length < wordCount) && (length < 0xffff) && (wordAt(i + length) == word))
+            {
+                ++length;
+            }
+
+            runs.put16(static_cast<std::uint16_t>(length));
+            runs.put16(word);
+            i += length;
+        }
+
+        return runs.bytes();
+    }
+};
+
+
+/**
+ * Stores each run of a repeated 16 bit word as its length and the
+ * word. \c bytes must hold a whole number of words.
+ */
+std::vector<std::uint8_t> CityFile::compressWordRuns(const std::vector<std::uint8_t>& bytes)
+{
+    return compressRuns(bytes.size() / 2, [&bytes](const std::size_t index) { return wordAt(bytes, index); });
+}
+
+
+/**
+ * Same as above for words that haven't been put into bytes yet.
+ */
+std::vector<std::uint8_t> CityFile::compressWordRuns(const std::vector<std::uint16_t>& words)
+{
+    return compressRuns(words.size(), [&words](const std::size_t index) { return words[index]; });
+}
+
+
+/**
+ * Reverses \c compressWordRuns(), giving back at most \c size bytes,
+ * and never more than \c MaxChunkSize.
+ */
+std::vector<std::uint8_t> CityFile::expandWordRuns(const std::vector<std::uint8_t>& runs, const std::size_t size)
+{
+    const std::size_t limit = std::min<std::size_t>(size, MaxChunkSize);
+
+    std::vector<std::uint8_t> bytes;
+    bytes.reserve(limit);
+
+    for (std::size_t i = 0; (i * 2) + 1 < runs.size() / 2; ++i)
+    {
+        const std::uint16_t length = wordAt(runs, i * 2);
+        const std::uint16_t word = wordAt(runs, (i * 2) + 1);
+        if (bytes.size() + (length * 2) > limit)
+        {
+            break;
+        }
+
+        for (std::uint16_t j = 0; j < length; ++j)
+        {
+            bytes.push_back(static_cast<std::uint8_t>(word & 0xff));
+            bytes.push_back(static_cast<std::uint8_t>(word >> 8));
+        }
+    }
+
+    return bytes;
+}
+
+
+void CityFile::ChunkData::put16(const std::uint16_t value)
+{
+    mBytes.push_back(static_cast<std::uint8_t>(value & 0xff));
+    mBytes.push_back(static_cast<std::uint8_t>(value >> 8));
+}
+
+
+void CityFile::ChunkData::put32(const std::uint32_t value)
+{
+    put16(static_cast<std::uint16_t>(value & 0xffff));
+    put16(static_cast<std::uint16_t>(value >> 16));
+}
+
+
+void CityFile::ChunkData::putString(const std::string& value)
+{
+    put32(static_cast<std::uint32_t>(value.size()));
+    mBytes.insert(mBytes.end(), value.begin(), value.end());
+
+    if (value.size() % 2)
+    {
+        mBytes.push_back(0);
+    }
+}
+
+
+std::uint16_t CityFile::ChunkData::get16()
+{
+    if (mPosition + 2 > mBytes.size())
+    {
+        throw std::runtime_error("CityFile::ChunkData::get16(): Read past the end of the chunk.");
+    }
+
+    const std::uint16_t value = wordAt(mBytes, mPosition / 2);
+    mPosition += 2;
+    return value;
+}
+
+
+std::uint32_t CityFile::ChunkData::get32()
+{
+    const std::uint32_t low = get16();
+    return low | (static_cast<std::uint32_t>(get16()) << 16);
+}
+
+
+std::string CityFile::ChunkData::getString()
+{
+    const std::size_t size = get32();
+    const std::size_t padded = size + (size % 2);
+    if (mPosition + padded > mBytes.size())
+    {
+        throw std::runtime_error("CityFile::ChunkData::getString(): Read past the end of the chunk.");
+    }
+
+    std::string value(mBytes.begin() + mPosition, mBytes.begin() + mPosition + size);
+    mPosition += padded;
+    return value;
+}
+
+
+CityFile::Writer::Writer(std::ostream& stream, const Header& header) :
+    mStream{ stream }
+{
+    mStream.write(Magic.data(), Magic.size());
+    write16(mStream, header.version);
+    write16(mStream, header.width);
+    write16(mStream, header.height);
+    write16(mStream, 0);
+    write32(mStream, header.seed);
+}
+
+
+/**
+ * Adds chunks to the end of a stream that already starts with a header.
+ */
+CityFile::Writer::Writer(std::ostream& stream) :
+    mStream{ stream }
+{}
+
+
+/**
+ * Writes a chunk, compressed if \c compression is set and it ends up
+ * smaller that way.
+ */
+void CityFile::Writer::chunk(const Tag& tag, const ChunkData& data, const Compression compression)
+{
+    const auto& bytes = data.bytes();
+
+    std::vector<std::uint8_t> stored;
+    Compression storedAs{ Compression::None };
+    if (compression == Compression::WordRuns)
+    {
+        stored = compressWordRuns(bytes);
+        storedAs = Compression::WordRuns;
+    }
+
+    if (storedAs == Compression::None || stored.size() >= bytes.size())
+    {
+        stored = bytes;
+        storedAs = Compression::None;
+    }
+
+    mStream.write(tag.data(), tag.size());
+    write32(mStream, static_cast<std::uint32_t>(storedAs));
+    write32(mStream, static_cast<std::uint32_t>(stored.size()));
+    write32(mStream, static_cast<std::uint32_t>(bytes.size()));
+    write32(mStream, crc32(bytes));
+    mStream.write(reinterpret_cast<const char*>(stored.data()), static_cast<std::streamsize>(stored.size()));
+}
+
+
+CityFile::Reader::Reader(std::istream& stream) :
+    mStream{ stream }
+{
+    if (!isCityFile(mStream))
+    {
+        throw std::runtime_error("CityFile::Reader(): Not a city file.");
+    }
+
+    mStream.ignore(Magic.size());
+    mHeader.version = read16(mStream);
+    mHeader.width = read16(mStream);
+    mHeader.height = read16(mStream);
+    read16(mStream);
+    mHeader.seed = read32(mStream);
+
+    if (!mStream || mHeader.version > Version)
+    {
+        throw std::runtime_error("CityFile::Reader(): Unsupported city file version.");
+    }
+}
+
+
+/**
+ * Reads the next chunk into \c tag and \c data. Returns false once
+ * there are no more chunks.
+ */
+bool CityFile::Reader::next(Tag& tag, ChunkData& data)
+{
+    if (!mStream.read(tag.data(), tag.size()))
+    {
+        return false;
+    }
+
+    const auto compression = static_cast<Compression>(read32(mStream));
+    const std::uint32_t storedSize = read32(mStream);
+    const std::uint32_t size = read32(mStream);
+    const std::uint32_t crc = read32(mStream);
+
+    if (!mStream || storedSize > bytesLeft(mStream))
+    {
+        throw std::runtime_error("CityFile::Reader::next(): Chunk is cut short.");
+    }
+
+    if (storedSize > MaxChunkSize || size > MaxChunkSize || (compression != Compression::WordRuns && storedSize != size))
+    {
+        throw std::runtime_error("CityFile::Reader::next(): Chunk size is corrupt.");
+    }
+
+    std::vector<std::uint8_t> stored(storedSize);
+    mStream.read(reinterpret_cast<char*>(stored.data()), storedSize);
+    if (!mStream)
+    {
+        throw std::runtime_error("CityFile::Reader::next(): Chunk is cut short.");
+    }
+
+    auto bytes = (compression == Compression::WordRuns) ? expandWordRuns(stored, size) : std::move(stored);
+    if (bytes.size() != size || crc32(bytes) != crc)
+    {
+        throw std::runtime_error("CityFile::Reader::next(): Chunk checksum doesn't match.");
+    }
+
+    data = ChunkData(std::move(bytes));
+    return true;
+}
+
+
+/**
+ * Checks for the magic number without moving the read position.
+ */
+bool CityFile::isCityFile(std::istream& stream)
+{
+    Tag magic{};
+    const auto position = stream.tellg();
+    stream.read(magic.data(), magic.size());
+    const bool matches = stream && (magic == Magic);
+
+    stream.clear();
+    stream.seekg(position);
+    return matches;
+}
+
+
+std::uint32_t CityFile::crc32(const std::vector<std::uint8_t>& bytes)
+{
+    std::uint32_t crc = 0xffffffffu;
+    for (const auto byte : bytes)
+    {
+        crc = CrcTable[(crc ^ byte) & 0xff] ^ (crc >> 8);
+    }
+
+    return crc ^ 0xffffffffu;
+}
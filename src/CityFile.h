@@ -0,0 +1,123 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+/**
+ * Container for saved cities.
+ *
+ * A file starts with a header giving the format version, the map
+ * size and the seed of the city's random generator, followed by any
+ * number of tagged chunks. Each chunk carries
+ * a CRC-32 of its contents and may be run length compressed, so
+ * chunks can be read, checked and skipped independently.
+ *
+ * Everything is stored little endian.
+ */
+namespace CityFile
+{
+	using Tag = std::array<char, 4>;
+
+	constexpr Tag Magic{ 'M', 'C', 'T', 'Y' };
+	constexpr std::uint16_t Version{ 1 };
+
+	/**
+	 * Largest chunk a reader accepts, stored or expanded. Nothing
+	 * written comes near it, a bigger size means the file is corrupt.
+	 */
+	constexpr std::uint32_t MaxChunkSize{ 16 * 1024 * 1024 };
+
+
+	struct Header
+	{
+		std::uint16_t version{ Version };
+		std::uint16_t width{};
+		std::uint16_t height{};
+		std::uint32_t seed{};
+	};
+
+
+	enum class Compression : std::uint8_t
+	{
+		None,
+		WordRuns // Runs of repeated 16 bit words
+	};
+
+
+	/**
+	 * Contents of a chunk, written and read back in the same order.
+	 */
+	class ChunkData
+	{
+	public:
+		ChunkData() = default;
+		explicit ChunkData(std::vector<std::uint8_t> bytes) : mBytes{ std::move(bytes) } {}
+
+		void put16(const std::uint16_t value);
+		void put32(const std::uint32_t value);
+		void putString(const std::string& value);
+
+		std::uint16_t get16();
+		std::uint32_t get32();
+		std::string getString();
+
+		const std::vector<std::uint8_t>& bytes() const { return mBytes; }
+
+	private:
+		std::vector<std::uint8_t> mBytes;
+		std::size_t mPosition{};
+	};
+
+
+	class Writer
+	{
+	public:
+		Writer(std::ostream& stream, const Header& header);
+		explicit Writer(std::ostream& stream);
+
+		void chunk(const Tag& tag, const ChunkData& data, const Compression compression);
+
+	private:
+		std::ostream& mStream;
+	};
+
+
+	class Reader
+	{
+	public:
+		explicit Reader(std::istream& stream);
+
+		const Header& header() const { return mHeader; }
+
+		bool next(Tag& tag, ChunkData& data);
+
+	private:
+		std::istream& mStream;
+		Header mHeader;
+	};
+
+
+	std::vector<std::uint8_t> compressWordRuns(const std::vector<std::uint8_t>& bytes);
+	std::vector<std::uint8_t> compressWordRuns(const std::vector<std::uint16_t>& words);
+	std::vector<std::uint8_t> expandWordRuns(const std::vector<std::uint8_t>& runs, const std::size_t size);
+
+	bool isCityFile(std::istream& stream);
+
+	std::uint32_t crc32(const std::vector<std::uint8_t>& bytes);
+};
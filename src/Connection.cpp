@@ -17,6 +17,9 @@
 
 #include "w_util.h"
 
+#include <array>
+#include <cstdint>
+
 
 namespace
 {
@@ -44,7 +47,7 @@ namespace
       214, 219, 218, 220
     };
 
-    unsigned int NeutralizeRoad(int tile)
+    constexpr unsigned int NeutralizeRoad(int tile)
     {
         unsigned int outValue = tile & LOMASK;
         if ((outValue >= 64) && (outValue <= 207))
@@ -54,12 +57,170 @@ namespace
 
         return outValue;
     }
+
+
+    enum class Network : std::uint8_t
+    {
+        None,
+        Road,
+        Rail,
+        Wire
+    };
+
+
+    /**
+     * Which networks a tile joins up with when it's the neighbour of
+     * the tile being fixed. North and south neighbours use the vertical
+     * bits, east and west neighbours the horizontal ones. Wires also
+     * need the neighbour's CONDBIT, which is checked on the map.
+     */
+    enum Link : std::uint8_t
+    {
+        RoadVertical = 1 << 0,
+        RoadHorizontal = 1 << 1,
+        RailVertical = 1 << 2,
+        RailHorizontal = 1 << 3,
+        WireVertical = 1 << 4,
+        WireHorizontal = 1 << 5
+    };
+
+
+    struct ConnectionProperties
+    {
+        Network network{ Network::None }; // network the tile is fixed up as
+        std::uint8_t links{};
+    };
+
+
+    constexpr ConnectionProperties connectionProperties(int tile)
+    {
+        const int t = NeutralizeRoad(tile);
+        ConnectionProperties properties{};
+
+        if ((t >= 66) && (t <= 76))
+        {
+            properties.network = Network::Road;
+        }
+        else if ((t >= 226) && (t <= 236))
+        {
+            properties.network = Network::Rail;
+        }
+        else if ((t >= 210) && (t <= 220))
+        {
+            properties.network = Network::Wire;
+        }
+
+        if (((t == 237) || ((t >= 64) && (t <= 78))) && (t != 77) && (t != 238) && (t != 64))
+        {
+            properties.links |= RoadVertical;
+        }
+
+        if (((t == 238) || ((t >= 64) && (t <= 78))) && (t != 78) && (t != 237) && (t != 65))
+        {
+            properties.links |= RoadHorizontal;
+        }
+
+        if ((t > 221) && (t <= 238) && (t != 237) && (t != 224))
+        {
+            properties.links |= RailVertical;
+        }
+
+        if ((t >= 221) && (t <= 238) && (t != 222) && (t != 238) && (t != 225))
+        {
+            properties.links |= RailHorizontal;
+        }
+
+        if ((t != 209) && (t != 78) && (t != 222))
+        {
+            properties.links |= WireVertical;
+        }
+
+        if ((t != 208) && (t != 77) && (t != 221))
+        {
+            properties.links |= WireHorizontal;
+        }
+
+        return properties;
+    }
+
+
+    constexpr std::array<ConnectionProperties, LOMASK + 1> buildConnectionTable()
+    {
+        std::array<ConnectionProperties, LOMASK + 1> table{};
+
+        for (int tile = 0; tile <= LOMASK; ++tile)
+        {
+            table[tile] = connectionProperties(tile);
+        }
+
+        return table;
+    }
+
+
+    constexpr auto ConnectionTable = buildConnectionTable();
+
+
+    struct NetworkFixup
+    {
+        const int* tiles; // indexed by the N, E, S, W neighbour mask
+        int flags;
+        std::uint8_t vertical;
+        std::uint8_t horizontal;
+        bool needsConduction;
+    };
+
+
+    const NetworkFixup& networkFixup(Network network)
+    {
+        static const std::array<NetworkFixup, 3> fixups
+        { {
+            { _RoadTable, BULLBIT | BURNBIT, RoadVertical, RoadHorizontal, false },
+            { _RailTable, BULLBIT | BURNBIT, RailVertical, RailHorizontal, false },
+            { _WireTable, BULLBIT | BURNBIT | CONDBIT, WireVertical, WireHorizontal, true }
+        } };
+
+        return fixups[static_cast<std::size_t>(network) - 1];
+    }
+
+
+    /**
+     * Picks the road, rail or wire piece at \c location that joins up
+     * with its neighbours. Anything else is left alone.
+     */
+    void fixTile(const Point<int>& location)
+    {
+        const auto network = ConnectionTable[Map[location.x][location.y] & LOMASK].network;
+        if (network == Network::None)
+        {
+            return;
+        }
+
+        const auto& fixup = networkFixup(network);
+
+        int neighbors{};
+        forEachNeighbor(location, [&fixup, &neighbors](const Point<int>& neighbor, const int direction)
+        {
+            const int tile = Map[neighbor.x][neighbor.y];
+            if (fixup.needsConduction && !(tile & CONDBIT))
+            {
+                return;
+            }
+
+            const auto link = (direction % 2 == 0) ? fixup.vertical : fixup.horizontal;
+            if (ConnectionTable[tile & LOMASK].links & link)
+            {
+                neighbors |= 1 << direction;
+            }
+        });
+
+        Map[location.x][location.y] = fixup.tiles[neighbors] | fixup.flags;
+    }
 }
 
 
-ToolResult _LayDoze(int x, int y, Budget& budget)
+ToolResult _LayDoze(int x, int y, ToolCharge& charge)
 {
-    if (budget.Broke())
+    if (charge.broke())
     {
         return ToolResult::InsufficientFunds; // no mas dinero.
     }
@@ -95,16 +256,16 @@ ToolResult _LayDoze(int x, int y, Budget& budget)
         break;
     }
 
-    budget.Spend(1); // Costs $1.00...
+    charge.spend(1); // Costs $1.00...
     return ToolResult::Success;
 }
 
 
-ToolResult _LayRoad(int x, int y, Budget& budget)
+ToolResult _LayRoad(int x, int y, ToolCharge& charge)
 {
     int cost = 10;
 
-    if (budget.CurrentFunds() < 10)
+    if (charge.funds() < 10)
     {
         return ToolResult::InsufficientFunds;
     }
@@ -118,7 +279,7 @@ ToolResult _LayRoad(int x, int y, Budget& budget)
     case RIVER: // Road on Water
     case REDGE:
     case CHANNEL: // Check how to build bridges, if possible.
-        if (budget.CurrentFunds() < 50)
+        if (charge.funds() < 50)
         {
             return ToolResult::InsufficientFunds;
         }
@@ -188,16 +349,16 @@ ToolResult _LayRoad(int x, int y, Budget& budget)
         return ToolResult::InvalidOperation;
     }
 
-    budget.Spend(cost);
+    charge.spend(cost);
     return ToolResult::Success;
 }
 
 
-ToolResult _LayRail(int x, int y, Budget& budget)
+ToolResult _LayRail(int x, int y, ToolCharge& charge)
 {
     int cost = 20;
 
-    if (budget.CurrentFunds() < 20)
+    if (charge.funds() < 20)
     {
         return ToolResult::InsufficientFunds;
     }
@@ -211,7 +372,7 @@ ToolResult _LayRail(int x, int y, Budget& budget)
     case RIVER: // Rail on Water
     case REDGE:
     case CHANNEL: // Check how to build underwater tunnel, if possible.
-        if (budget.CurrentFunds() < 100)
+        if (charge.funds() < 100)
         {
             return ToolResult::InsufficientFunds;
         }
@@ -280,16 +441,16 @@ ToolResult _LayRail(int x, int y, Budget& budget)
         return ToolResult::InvalidOperation;
     }
 
-    budget.Spend(cost);
+    charge.spend(cost);
     return ToolResult::Success;
 }
 
 
-ToolResult _LayWire(int x, int y, Budget& budget)
+ToolResult _LayWire(int x, int y, ToolCharge& charge)
 {
     int cost = 5;
 
-    if (budget.CurrentFunds() < 5)
+    if (charge.funds() < 5)
     {
         return ToolResult::InsufficientFunds;
     }
@@ -303,7 +464,7 @@ ToolResult _LayWire(int x, int y, Budget& budget)
     case RIVER: // Wire on Water
     case REDGE:
     case CHANNEL: // Check how to lay underwater wire, if possible.
-        if (budget.CurrentFunds() < 25)
+        if (charge.funds() < 25)
         {
             return ToolResult::InsufficientFunds;
         }
@@ -389,203 +550,112 @@ ToolResult _LayWire(int x, int y, Budget& budget)
         return ToolResult::InvalidOperation;
     }
 
-    budget.Spend(cost);
+    charge.spend(cost);
     return ToolResult::Success;
 }
 
 
-void _FixSingle(int x, int y)
+int ToolCharge::funds() const
 {
-    int Tile = NeutralizeRoad(Map[x][y] & LOMASK);
-    int adjTile = 0;
-
-    // Cleanup Road
-    if ((Tile >= 66) && (Tile <= 76))
-    {
-        if (y > 0)
-        {
-            Tile = NeutralizeRoad(Map[x][y - 1]);
-            if (((Tile == 237) || ((Tile >= 64) && (Tile <= 78))) && (Tile != 77) && (Tile != 238) && (Tile != 64))
-            {
-                adjTile |= 0x0001;
-            }
-        }
+    return mBudget.CurrentFunds() - mSpent;
+}
 
-        if (x < (SimWidth - 1))
-        {
-            Tile = NeutralizeRoad(Map[x + 1][y]);
-            if (((Tile == 238) || ((Tile >= 64) && (Tile <= 78))) && (Tile != 78) && (Tile != 237) && (Tile != 65))
-            {
-                adjTile |= 0x0002;
-            }
-        }
 
-        if (y < (SimHeight - 1))
-        {
-            Tile = NeutralizeRoad(Map[x][y + 1]);
-            if (((Tile == 237) || ((Tile >= 64) && (Tile <= 78))) && (Tile != 77) && (Tile != 238) && (Tile != 64))
-            {
-                adjTile |= 0x0004;
-            }
-        }
+void ToolCharge::commit()
+{
+    mBudget.Spend(mSpent);
+    mSpent = 0;
+}
 
-        if (x > 0)
-        {
-            Tile = NeutralizeRoad(Map[x - 1][y]);
-            if (((Tile == 238) || ((Tile >= 64) && (Tile <= 78))) && (Tile != 78) && (Tile != 237) && (Tile != 65))
-            {
-                adjTile |= 0x0008;
-            }
-        }
 
-        Map[x][y] = _RoadTable[adjTile] | BULLBIT | BURNBIT;
-        return;
-    }
+/**
+ * Queues \c location and its four neighbours.
+ */
+void ConnectionFixup::add(const Point<int>& location)
+{
+    queue(location);
 
-    // Cleanup Rail
-    if ((Tile >= 226) && (Tile <= 236))
+    forEachNeighbor(location, [this](const Point<int>& neighbor, int)
     {
+        queue(neighbor);
+    });
+}
 
-        if (y > 0)
-        {
-            Tile = NeutralizeRoad(Map[x][y - 1]);
-            if ((Tile >= 221) && (Tile <= 238) && (Tile != 221) && (Tile != 237) && (Tile != 224))
-            {
-                adjTile |= 0x0001;
-            }
-        }
-
-        if (x < (SimWidth - 1))
-        {
-            Tile = NeutralizeRoad(Map[x + 1][y]);
-            if ((Tile >= 221) && (Tile <= 238) && (Tile != 222) && (Tile != 238) && (Tile != 225))
-            {
-                adjTile |= 0x0002;
-            }
-        }
-
-        if (y < (SimHeight - 1))
-        {
-            Tile = NeutralizeRoad(Map[x][y + 1]);
-            if ((Tile >= 221) && (Tile <= 238) && (Tile != 221) && (Tile != 237) && (Tile != 224))
-            {
-                adjTile |= 0x0004;
-            }
-        }
-
-        if (x > 0)
-        {
-            Tile = NeutralizeRoad(Map[x - 1][y]);
-            if ((Tile >= 221) && (Tile <= 238) && (Tile != 222) && (Tile != 238) && (Tile != 225))
-            {
-                adjTile |= 0x0008;
-            }
-        }
-
-        Map[x][y] = _RailTable[adjTile] | BULLBIT | BURNBIT;
-        return;
-    }
 
-    // Cleanup Wire
-    if ((Tile >= 210) && (Tile <= 220))
+/**
+ * Fixes \c location now if it's queued. Tools look at the tile they
+ * are laid on, so it has to be up to date before the next one goes
+ * down. It stays queued, fixing a tile twice gives the same result.
+ */
+void ConnectionFixup::settle(const Point<int>& location)
+{
+    if (!mQueued.empty() && mQueued[index(location)])
     {
-
-        if (y > 0)
-        {
-            Tile = Map[x][y - 1];
-            if (Tile & CONDBIT)
-            {
-                Tile = NeutralizeRoad(Tile);
-                if ((Tile != 209) && (Tile != 78) && (Tile != 222))
-                {
-                    adjTile |= 0x0001;
-                }
-            }
-        }
-
-        if (x < (SimWidth - 1))
-        {
-            Tile = Map[x + 1][y];
-            if (Tile & CONDBIT)
-            {
-                Tile = NeutralizeRoad(Tile);
-                if ((Tile != 208) && (Tile != 77) && (Tile != 221))
-                {
-                    adjTile |= 0x0002;
-                }
-            }
-        }
-
-        if (y < (SimHeight - 1))
-        {
-            Tile = Map[x][y + 1];
-            if (Tile & CONDBIT)
-            {
-                Tile = NeutralizeRoad(Tile);
-                if ((Tile != 209) && (Tile != 78) && (Tile != 222))
-                {
-                    adjTile |= 0x0004;
-                }
-            }
-        }
-
-        if (x > 0)
-        {
-            Tile = Map[x - 1][y];
-            if (Tile & CONDBIT)
-            {
-                Tile = NeutralizeRoad(Tile);
-                if ((Tile != 208) && (Tile != 77) && (Tile != 221))
-                {
-                    adjTile |= 0x0008;
-                }
-            }
-        }
-
-        Map[x][y] = _WireTable[adjTile] | BULLBIT | BURNBIT | CONDBIT;
-        return;
+        fixTile(location);
     }
 }
 
 
-void _FixZone(int x, int y)
+/**
+ * Fixes every queued tile once. The piece chosen for a tile only
+ * depends on which network its neighbours belong to and fixing never
+ * changes that, so the order doesn't matter.
+ */
+void ConnectionFixup::apply()
 {
-    _FixSingle(x, y);
-
-    if (y > 0)
+    for (const auto& location : mPending)
     {
-        _FixSingle(x, y - 1);
+        fixTile(location);
     }
 
-    if (x < (SimWidth - 1))
-    {
-        _FixSingle(x + 1, y);
-    }
+    mPending.clear();
+    mQueued.clear();
+}
+
 
-    if (y < (SimHeight - 1))
+void ConnectionFixup::queue(const Point<int>& location)
+{
+    if (mQueued.empty())
     {
-        _FixSingle(x, y + 1);
+        mQueued.resize(SimWidth * SimHeight);
     }
 
-    if (x > 0)
+    if (!mQueued[index(location)])
     {
-        _FixSingle(x - 1, y);
+        mQueued[index(location)] = true;
+        mPending.push_back(location);
     }
 }
 
 
+std::size_t ConnectionFixup::index(const Point<int>& location)
+{
+    return static_cast<std::size_t>(location.x * SimHeight + location.y);
+}
+
+
 ToolResult CanConnectTile(int x, int y, Tool tool, Budget& budget)
+{
+    return CanConnectTile(Map, x, y, tool, budget.CurrentFunds(), AutoBulldoze);
+}
+
+
+/**
+ * Checks \c tool at \c x, \c y against \c map, which needn't be the
+ * live map, e.g. a snapshot the UI is drawing from.
+ */
+ToolResult CanConnectTile(const TileMap& map, int x, int y, Tool tool, int funds, bool autoBulldoze)
 {
     const int cost = toolProperties(tool).cost;
 
-    if (budget.CurrentFunds() < cost)
+    if (funds < cost)
     {
         return ToolResult::InsufficientFunds;
     }
 
-    if ((AutoBulldoze) && (budget.CurrentFunds() > 0) && (Map[x][y] & BULLBIT))
+    if (autoBulldoze && (funds > 0) && (map[x][y] & BULLBIT))
     {
-        const int tile = NeutralizeRoad(Map[x][y]);
+        const int tile = NeutralizeRoad(map[x][y]);
         // Maybe this should check BULLBIT instead of checking tile values?
         if (((tile >= TINYEXP) && (tile <= LASTTINYEXP)) || ((tile < 64) && (tile != 0)))
         {
@@ -593,7 +663,7 @@ ToolResult CanConnectTile(int x, int y, Tool tool, Budget& budget)
         }
     }
 
-    switch (Map[x][y])
+    switch (map[x][y])
     {
     case DIRT:
         break;
@@ -622,18 +692,40 @@ ToolResult CanConnectTile(int x, int y, Tool tool, Budget& budget)
 
 ToolResult ConnectTile(int x, int y, Tool tool, Budget& budget)
 {
+    ToolCharge charge{ budget };
+    ConnectionFixup fixup;
+
+    const auto result = ConnectTile(x, y, tool, charge, fixup);
+
+    fixup.apply();
+    charge.commit();
+
+    return result;
+}
+
+
+/**
+ * Lays \c tool at \c x, \c y, adds its cost to \c charge and queues
+ * the connections around it on \c fixup instead of fixing them straight
+ * away, so a drag or a large edit is paid for and fixed up once at the
+ * end.
+ */
+ToolResult ConnectTile(int x, int y, Tool tool, ToolCharge& charge, ConnectionFixup& fixup)
+{
+    fixup.settle({ x, y });
+
     int Tile = Map[x][y];
 
     // AutoDoze
     if (tool == Tool::Rail || tool == Tool::Road || tool == Tool::Wire)
     {
-        if ((AutoBulldoze) && (budget.CurrentFunds() > 0) && (Tile & BULLBIT))
+        if ((AutoBulldoze) && (charge.funds() > 0) && (Tile & BULLBIT))
         {
             Tile = NeutralizeRoad(Tile);
             // Maybe this should check BULLBIT instead of checking tile values?
             if (((Tile >= TINYEXP) && (Tile <= LASTTINYEXP)) || ((Tile < 64) && (Tile != 0)))
             {
-                budget.Spend(1);
+                charge.spend(1);
                 Map[x][y] = 0;
             }
         }
@@ -643,27 +735,22 @@ ToolResult ConnectTile(int x, int y, Tool tool, Budget& budget)
     switch (tool)
     {
     case Tool::None:
-        _FixZone(x, y);
         break;
 
     case Tool::Bulldoze:
-        result = _LayDoze(x, y, budget);
-        _FixZone(x, y);
+        result = _LayDoze(x, y, charge);
         break;
 
     case Tool::Road:
-        result = _LayRoad(x, y, budget);
-        _FixZone(x, y);
+        result = _LayRoad(x, y, charge);
         break;
 
     case Tool::Rail:
-        result = _LayRail(x, y, budget);
-        _FixZone(x, y);
+        result = _LayRail(x, y, charge);
         break;
 
     case Tool::Wire:
-        result = _LayWire(x, y, budget);
-        _FixZone(x, y);
+        result = _LayWire(x, y, charge);
         break;
 
     default:
@@ -671,5 +758,6 @@ ToolResult ConnectTile(int x, int y, Tool tool, Budget& budget)
         break;
     }
 
+    fixup.add({ x, y });
     return result;
 }
@@ -10,8 +10,13 @@
 // file, included in this distribution, for details.
 #pragma once
 
+#include "Map.h"
+#include "Point.h"
 #include "Tool.h"
 
+#include <cstddef>
+#include <vector>
+
 class Budget;
 
 enum class ToolOperation
@@ -21,5 +26,50 @@ enum class ToolOperation
 	Wire
 };
 
+
+/**
+ * Running cost of a batch of tool operations. Funds checks see what is
+ * left after the batch so far and \c commit() takes the total from the
+ * budget in one go.
+ */
+class ToolCharge
+{
+public:
+	explicit ToolCharge(Budget& budget) : mBudget{ budget } {}
+
+	int funds() const;
+	bool broke() const { return funds() <= 0; }
+	int spent() const { return mSpent; }
+
+	void spend(const int amount) { mSpent += amount; }
+	void commit();
+
+private:
+	Budget& mBudget;
+	int mSpent{};
+};
+
+
+/**
+ * Road, rail and wire tiles waiting to be joined up with their
+ * neighbours.
+ */
+class ConnectionFixup
+{
+public:
+	void add(const Point<int>& location);
+	void settle(const Point<int>& location);
+	void apply();
+
+private:
+	void queue(const Point<int>& location);
+	static std::size_t index(const Point<int>& location);
+
+	std::vector<Point<int>> mPending;
+	std::vector<bool> mQueued;
+};
+
 ToolResult ConnectTile(int x, int y, Tool, Budget&);
+ToolResult ConnectTile(int x, int y, Tool, ToolCharge&, ConnectionFixup&);
 ToolResult CanConnectTile(int x, int y, Tool, Budget&);
+ToolResult CanConnectTile(const TileMap&, int x, int y, Tool, int funds, bool autoBulldoze);
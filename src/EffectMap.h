@@ -70,6 +70,28 @@ public:
         }
     }
 
+    /**
+     * Calls \c function with every point from \c begin up to \c end,
+     * row by row, which is the order the values are stored in.
+     */
+    template <typename Function>
+    void forEachCell(const Point<int>& begin, const Point<int>& end, Function&& function) const
+    {
+        for (int y = begin.y; y < end.y; ++y)
+        {
+            for (int x = begin.x; x < end.x; ++x)
+            {
+                function(Point<int>{ x, y });
+            }
+        }
+    }
+
+    template <typename Function>
+    void forEachCell(Function&& function) const
+    {
+        forEachCell({ 0, 0 }, { mDimensions.x, mDimensions.y }, function);
+    }
+
 private:
     std::vector<int> mEffectMap{};
 
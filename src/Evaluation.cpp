@@ -194,6 +194,41 @@ void EvalInit()
 }
 
 
+EvaluationState evaluationState()
+{
+    return
+    {
+        EvalValid, CityYes, CityNo, EvalChanged,
+        ProblemTable, ProblemTaken, ProblemVotes, ProblemOrder,
+        CityPop, deltaCityPop, CityAssessedValue, CityClass,
+        CityScore, DeltaCityScore, AverageCityScore, TrafficAverage
+    };
+}
+
+
+void evaluationState(const EvaluationState& state)
+{
+    EvalValid = state.valid;
+    CityYes = state.yes;
+    CityNo = state.no;
+    EvalChanged = state.changed;
+
+    ProblemTable = state.problemTable;
+    ProblemTaken = state.problemTaken;
+    ProblemVotes = state.problemVotes;
+    ProblemOrder = state.problemOrder;
+
+    CityPop = state.population;
+    deltaCityPop = state.deltaPopulation;
+    CityAssessedValue = state.assessedValue;
+    CityClass = state.cityClass;
+    CityScore = state.score;
+    DeltaCityScore = state.deltaScore;
+    AverageCityScore = state.averageScore;
+    TrafficAverage = state.trafficAverage;
+}
+
+
 void ChangeEval()
 {
     EvalChanged = true;
@@ -17,6 +17,35 @@ class CityProperties;
 
 constexpr auto PROBNUM = 10;
 
+
+/**
+ * Everything the evaluation keeps from one run to the next.
+ */
+struct EvaluationState
+{
+	int valid{};
+	int yes{};
+	int no{};
+	bool changed{};
+
+	std::array<int, PROBNUM> problemTable{};
+	std::array<int, PROBNUM> problemTaken{};
+	std::array<int, PROBNUM> problemVotes{};
+	std::array<int, 4> problemOrder{};
+
+	int population{};
+	int deltaPopulation{};
+	int assessedValue{};
+	int cityClass{};
+	int score{};
+	int deltaScore{};
+	int averageScore{};
+	int trafficAverage{};
+};
+
+EvaluationState evaluationState();
+void evaluationState(const EvaluationState& state);
+
 int cityAssessedValue();
 
 int cityClass();
@@ -28,6 +28,8 @@ public:
 	const std::string& savePath() const { return mSavePath; }
 	const std::string& fileName() const { return mFileName; }
 	const std::string fullPath() const { return mSavePath + "\\" + mFileName; }
+	const std::string autosavePath() const { return mSavePath.empty() ? AutosaveFileName : mSavePath + "\\" + AutosaveFileName; }
+	const std::string journalPath() const { return mSavePath.empty() ? JournalFileName : mSavePath + "\\" + JournalFileName; }
 
 	bool pickSaveFile();
 	bool pickOpenFile();
@@ -35,6 +37,9 @@ public:
 	bool filePicked() const;
 
 private:
+	static constexpr const char* AutosaveFileName{ "autosave.cty" };
+	static constexpr const char* JournalFileName{ "journal.cty" };
+
 	enum class FileOperation { Open, Save };
 
 	bool showFileDialog(FileOperation);
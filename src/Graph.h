@@ -21,7 +21,7 @@ struct Graph
 {
     using PointsList = std::array<SDL_Point, HistoryLength>;
 
-    const GraphHistory& history;
+    const GraphHistory* history;
     const std::string name;
     const SDL_Color color;
     PointsList points;
@@ -29,25 +29,17 @@ namespace
 	SDL_Rect TitleBarPosition = TitleBarLayout;
 
 
-	enum class ButtonId
-	{
-		Residential,
-		Commercial,
-		Industrial,
-		Pollution,
-		Crime,
-		Money
-	};
+	using ButtonId = GraphWindow::ButtonId;
 
 
 	std::map<ButtonId, Graph> HistoryGraphTable
 	{
-		{ ButtonId::Residential, { ResHis, "Residential", Colors::LightGreen, { 0 } } },
-		{ ButtonId::Commercial, { ComHis, "Commercial", Colors::DarkBlue, { 0 } } },
-		{ ButtonId::Industrial, { IndHis, "Industrial", Colors::Gold, { 0 } } },
-		{ ButtonId::Money, { MoneyHis, "Cash Flow", Colors::Turquoise, { 0 } } },
-		{ ButtonId::Crime, { CrimeHis, "Crime", Colors::Red, { 0 } } },
-		{ ButtonId::Pollution, { PollutionHis, "Pollution", Colors::Olive, { 0 } } }
+		{ ButtonId::Residential, { &ResHis, "Residential", Colors::LightGreen, { 0 } } },
+		{ ButtonId::Commercial, { &ComHis, "Commercial", Colors::DarkBlue, { 0 } } },
+		{ ButtonId::Industrial, { &IndHis, "Industrial", Colors::Gold, { 0 } } },
+		{ ButtonId::Money, { &MoneyHis, "Cash Flow", Colors::Turquoise, { 0 } } },
+		{ ButtonId::Crime, { &CrimeHis, "Crime", Colors::Red, { 0 } } },
+		{ ButtonId::Pollution, { &PollutionHis, "Pollution", Colors::Olive, { 0 } } }
 	};
 
 
@@ -196,11 +188,17 @@ void GraphWindow::draw()
 }
 
 
+void GraphWindow::linkHistory(ButtonId id, const GraphHistory& history)
+{
+	HistoryGraphTable.at(id).history = &history;
+}
+
+
 void GraphWindow::update()
 {
 	for (auto& [type, graph] : HistoryGraphTable)
 	{
-		fillGraphPoints(graph.points, graph.history);
+		fillGraphPoints(graph.points, *graph.history);
 	}
 
 	SDL_SetRenderTarget(MainWindowRenderer, mGraphTexture.texture);
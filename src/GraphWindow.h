@@ -19,6 +19,17 @@
 
 class GraphWindow : public WindowBase
 {
+public:
+	enum class ButtonId
+	{
+		Residential,
+		Commercial,
+		Industrial,
+		Pollution,
+		Crime,
+		Money
+	};
+
 public:
 	GraphWindow() = delete;
 	GraphWindow(const GraphWindow&) = delete;
@@ -31,6 +42,8 @@ public:
 	void injectMouseUp() override;
 	void injectMouseMotion(const Vector<int>& delta) override;
 
+	void linkHistory(ButtonId id, const GraphHistory& history);
+
 	void draw() override;
 	void update() override;
 
@@ -0,0 +1,438 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#include "Journal.h"
+
+#include "Budget.h"
+#include "CityProperties.h"
+#include "Evaluation.h"
+
+#include "g_ani.h"
+
+#include "main.h"
+#include "Map.h"
+
+#include "s_disast.h"
+#include "s_fileio.h"
+#include "s_sim.h"
+
+#include "Sprite.h"
+#include "Tool.h"
+
+#include "w_util.h"
+
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+
+
+namespace
+{
+    constexpr CityFile::Tag JournalHeaderChunk{ 'J', 'H', 'D', 'R' };
+    constexpr CityFile::Tag JournalChunk{ 'J', 'R', 'N', 'L' };
+
+    // Values stored for each command, in Journal::Command order.
+    constexpr std::array<std::size_t, 10> ValueCount{ 3, 7, 4, 1, 0, 0, 1, 1, 0, 2 };
+
+
+    std::size_t valueCount(const Journal::Command command)
+    {
+        const auto index = static_cast<std::size_t>(command);
+        if (index >= ValueCount.size())
+        {
+            throw std::runtime_error("Journal: Unknown command " + std::to_string(index) + ".");
+        }
+
+        return ValueCount[index];
+    }
+
+
+    std::int32_t floatBits(const float value)
+    {
+        std::int32_t bits{};
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+
+    float bitsFloat(const std::int32_t bits)
+    {
+        float value{};
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+
+    std::uint64_t cityHash(const Budget& budget)
+    {
+        std::uint64_t hash{ 1469598103934665603ull };
+
+        const auto add = [&hash](const std::int64_t value)
+        {
+            hash ^= static_cast<std::uint64_t>(value);
+            hash *= 1099511628211ull;
+        };
+
+        for (const auto& column : Map)
+        {
+            for (const auto tile : column)
+            {
+                add(tile);
+            }
+        }
+
+        add(CityTime);
+        add(TotalPop);
+        add(budget.CurrentFunds());
+
+        return hash;
+    }
+
+
+    void triggerDisaster(const Journal::Disaster disaster)
+    {
+        switch (disaster)
+        {
+        case Journal::Disaster::Fire: MakeFire(); break;
+        case Journal::Disaster::Flood: MakeFlood(); break;
+        case Journal::Disaster::Meltdown: MakeMeltdown(); break;
+        case Journal::Disaster::Earthquake: MakeEarthquake(); break;
+        case Journal::Disaster::Monster: generateMonster(); break;
+        case Journal::Disaster::Tornado: generateTornado(); break;
+        }
+    }
+};
+
+
+/**
+ * Saves the city to \c filename and loads it back, so recording
+ * starts from exactly the state a replay will load, then reseeds
+ * the random number generator.
+ */
+Journal::Journal(const std::string& filename, CityProperties& properties, Budget& budget):
+    mBudget(budget),
+    mWriter(mStream)
+{
+    auto city = std::make_unique<SavedCity>();
+    captureCity(*city, properties, budget);
+
+    if (!writeCity(filename, *city) || !LoadCity(filename, properties, budget))
+    {
+        throw std::runtime_error("Journal(): Unable to start a journal in '" + filename + "'.");
+    }
+
+    mStream.open(filename, std::ofstream::binary | std::ofstream::app);
+    if (mStream.fail())
+    {
+        throw std::runtime_error("Journal(): Unable to open '" + filename + "' for writing.");
+    }
+
+    const auto seed = std::random_device{}();
+    SeedRandom(seed);
+
+    CityFile::ChunkData header;
+    header.put32(seed);
+    header.put16(parallelSimulation() ? 1 : 0);
+    mWriter.chunk(JournalHeaderChunk, header, CityFile::Compression::None);
+    mStream.flush();
+
+    mFrameBudget = simulationFrameBudget();
+    simulationFrameBudget(std::chrono::microseconds::zero());
+
+    mStartFrame = simulationFrame();
+}
+
+
+/**
+ * Ends the journal with a checkpoint of the city as it is now.
+ */
+Journal::~Journal()
+{
+    checkpoint();
+    flush();
+
+    simulationFrameBudget(mFrameBudget);
+}
+
+
+/**
+ * Adds \c entry, stamped with the current frame. Call before
+ * applying it, from the simulation thread or while it's held.
+ */
+void Journal::record(const Entry& entry)
+{
+    mEntries.push_back(entry);
+    mEntries.back().frame = simulationFrame() - mStartFrame;
+}
+
+
+/**
+ * Call after every simulation frame. Adds a checkpoint when one is
+ * due and writes out everything recorded since the last one.
+ */
+void Journal::frame()
+{
+    const std::uint32_t frame = simulationFrame() - mStartFrame;
+    if (frame % CheckpointInterval != 0 || frame == mLastFrame)
+    {
+        return;
+    }
+
+    mLastFrame = frame;
+
+    checkpoint();
+    flush();
+}
+
+
+void Journal::checkpoint()
+{
+    const auto hash = cityHash(mBudget);
+    record({ Command::Checkpoint, { static_cast<std::int32_t>(hash), static_cast<std::int32_t>(hash >> 32) } });
+}
+
+
+void Journal::flush()
+{
+    if (mEntries.empty())
+    {
+        return;
+    }
+
+    CityFile::ChunkData data;
+    data.put32(static_cast<std::uint32_t>(mEntries.size()));
+
+    for (const auto& entry : mEntries)
+    {
+        data.put32(entry.frame);
+        data.put16(static_cast<std::uint16_t>(entry.command));
+
+        for (std::size_t i = 0; i < valueCount(entry.command); ++i)
+        {
+            data.put32(static_cast<std::uint32_t>(entry.values[i]));
+        }
+    }
+
+    mWriter.chunk(JournalChunk, data, CityFile::Compression::WordRuns);
+    mStream.flush();
+
+    mEntries.clear();
+}
+
+
+/**
+ * Carries out a recorded command. Checkpoints do nothing here.
+ */
+void Journal::apply(const Entry& entry, Budget& budget)
+{
+    const auto& values = entry.values;
+
+    switch (entry.command)
+    {
+    case Command::ToolDown:
+        ToolDown(static_cast<Tool>(values[0]), { values[1], values[2] }, budget);
+        break;
+
+    case Command::DragTool:
+    {
+        const Tool tool = static_cast<Tool>(values[0]);
+        const Point<int> origin{ values[1], values[2] };
+        Vector<int> toolVector{ values[3], values[4] };
+
+        validateDraggableToolVector(tool, origin, toolVector, budget);
+        executeDraggableTool(tool, origin, toolVector, { values[5], values[6] }, budget);
+        break;
+    }
+
+    case Command::Budget:
+        budget.TaxRate(values[0]);
+        budget.RoadPercent(bitsFloat(values[1]));
+        budget.PolicePercent(bitsFloat(values[2]));
+        budget.FirePercent(bitsFloat(values[3]));
+        break;
+
+    case Command::Speed:
+        if (Paused()) { Resume(); }
+        SimSpeed(static_cast<SimulationSpeed>(values[0]));
+        break;
+
+    case Command::Pause:
+        Pause();
+        break;
+
+    case Command::Resume:
+        Resume();
+        break;
+
+    case Command::ParallelSimulation:
+        parallelSimulation(values[0] != 0);
+        break;
+
+    case Command::Disaster:
+        triggerDisaster(static_cast<Disaster>(values[0]));
+        break;
+
+    case Command::Animation:
+        animateTiles();
+        updateSprites();
+        break;
+
+    case Command::Checkpoint:
+        break;
+    }
+}
+
+
+/**
+ * Budget command holding the rates currently set in \c budget.
+ */
+Journal::Entry Journal::budgetEntry(const Budget& budget)
+{
+    return
+    {
+        Command::Budget,
+        {
+            budget.TaxRate(),
+            floatBits(budget.RoadPercent()),
+            floatBits(budget.PolicePercent()),
+            floatBits(budget.FirePercent())
+        }
+    };
+}
+
+
+/**
+ * Loads the city in a journal and runs its commands as fast as
+ * possible, comparing the city against every checkpoint. Returns
+ * false if the file can't be read or the replay went differently.
+ */
+bool Journal::replay(const std::string& filename, CityProperties& properties, Budget& budget)
+{
+    std::ifstream stream(filename, std::ifstream::binary);
+    if (stream.fail() || !CityFile::isCityFile(stream))
+    {
+        std::cout << "Unable to read a journal from the file named '" << filename << "'" << std::endl;
+        return false;
+    }
+
+    bool started{ false };
+    std::uint32_t seed{};
+    bool parallel{ false };
+    std::vector<Entry> entries;
+
+    try
+    {
+        CityFile::Reader reader(stream);
+        CityFile::Tag tag{};
+        CityFile::ChunkData data;
+        while (reader.next(tag, data))
+        {
+            if (tag == JournalHeaderChunk)
+            {
+                started = true;
+                seed = data.get32();
+                parallel = data.get16() != 0;
+            }
+            else if (tag == JournalChunk)
+            {
+                const std::uint32_t count = data.get32();
+                for (std::uint32_t i = 0; i < count; ++i)
+                {
+                    Entry entry;
+                    entry.frame = data.get32();
+                    entry.command = static_cast<Command>(data.get16());
+
+                    for (std::size_t value = 0; value < valueCount(entry.command); ++value)
+                    {
+                        entry.values[value] = static_cast<std::int32_t>(data.get32());
+                    }
+
+                    entries.push_back(entry);
+                }
+            }
+        }
+    }
+    catch (const std::runtime_error& error)
+    {
+        // A journal cut short by a crash replays up to its last good chunk.
+        std::cout << error.what() << std::endl;
+    }
+
+    if (!started)
+    {
+        std::cout << "The file named '" << filename << "' doesn't hold a journal" << std::endl;
+        return false;
+    }
+
+    // Loading runs a first scan, which has to be done the same way it was when recording.
+    parallelSimulation(parallel);
+
+    if (!LoadCity(filename, properties, budget))
+    {
+        return false;
+    }
+
+    SeedRandom(seed);
+
+    const auto frameBudget = simulationFrameBudget();
+    simulationFrameBudget(std::chrono::microseconds::zero());
+
+    const std::uint32_t startFrame = simulationFrame();
+    std::size_t checkpoints{ 0 };
+    bool matched{ true };
+
+    for (const auto& entry : entries)
+    {
+        while (matched && simulationFrame() - startFrame < entry.frame)
+        {
+            const std::uint32_t frame = simulationFrame();
+            SimFrame(properties, budget);
+            scoreDoer(properties);
+
+            if (simulationFrame() == frame)
+            {
+                std::cout << "Replay stalled at frame " << frame - startFrame << ", the simulation is paused" << std::endl;
+                matched = false;
+            }
+        }
+
+        if (!matched)
+        {
+            break;
+        }
+
+        if (entry.command == Command::Checkpoint)
+        {
+            const auto hash = cityHash(budget);
+            if (static_cast<std::int32_t>(hash) != entry.values[0] || static_cast<std::int32_t>(hash >> 32) != entry.values[1])
+            {
+                std::cout << "Replay went different before frame " << entry.frame << std::endl;
+                matched = false;
+                break;
+            }
+
+            ++checkpoints;
+            continue;
+        }
+
+        apply(entry, budget);
+    }
+
+    simulationFrameBudget(frameBudget);
+
+    if (matched)
+    {
+        std::cout << "Replayed " << simulationFrame() - startFrame << " frames, " << checkpoints << " checkpoints matched" << std::endl;
+    }
+
+    return matched;
+}
@@ -0,0 +1,103 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#pragma once
+
+#include "CityFile.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+class Budget;
+class CityProperties;
+
+
+/**
+ * Record of everything that changes a city while it runs.
+ *
+ * A journal file is a saved city followed by the random seed and
+ * every command applied to it, each stamped with the number of
+ * simulation frames run before it. Every so often a hash of the
+ * city is recorded as a checkpoint so a replay can tell whether,
+ * and roughly when, it went a different way.
+ *
+ * While a journal is open phases aren't split across frames, so
+ * the frame a command lands on doesn't depend on machine speed.
+ */
+class Journal
+{
+public:
+	enum class Command : std::uint16_t
+	{
+		ToolDown, // tool, x, y
+		DragTool, // tool, origin x, origin y, vector x, vector y, x, y
+		Budget, // tax rate, road, police and fire percent (float bits)
+		Speed, // speed
+		Pause,
+		Resume,
+		ParallelSimulation, // enabled
+		Disaster, // disaster
+		Animation,
+		Checkpoint // low and high words of the city hash
+	};
+
+	enum class Disaster
+	{
+		Fire,
+		Flood,
+		Meltdown,
+		Earthquake,
+		Monster,
+		Tornado
+	};
+
+	struct Entry
+	{
+		Command command{};
+		std::array<std::int32_t, 7> values{};
+		std::uint32_t frame{};
+	};
+
+	Journal() = delete;
+	Journal(const Journal&) = delete;
+	const Journal& operator=(const Journal&) = delete;
+
+	Journal(const std::string& filename, CityProperties&, Budget&);
+	~Journal();
+
+	void record(const Entry&);
+	void frame();
+
+	static void apply(const Entry&, Budget&);
+	static Entry budgetEntry(const Budget&);
+
+	static bool replay(const std::string& filename, CityProperties&, Budget&);
+
+private:
+	static constexpr std::uint32_t CheckpointInterval{ 256 };
+
+	void checkpoint();
+	void flush();
+
+	const Budget& mBudget;
+
+	std::ofstream mStream;
+	CityFile::Writer mWriter;
+
+	std::vector<Entry> mEntries;
+
+	std::uint32_t mStartFrame{};
+	std::uint32_t mLastFrame{};
+	std::chrono::microseconds mFrameBudget{};
+};
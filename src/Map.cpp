@@ -15,6 +15,7 @@
 #include "Point.h"
 
 #include "Texture.h"
+#include "TileProperties.h"
 #include "Sprite.h"
 
 #include "w_util.h"
@@ -98,24 +99,18 @@ bool tileIsZoned(const unsigned int tile)
 
 bool tileIsRoad(const Point<int> coordinates)
 {
-	if (!CoordinatesValid(coordinates))
-	{
-		return false;
-	}
-
-	const auto tile = maskedTileValue(coordinates);
+	return tileIsRoad(Map, coordinates);
+}
 
-	if (tile < ROADBASE || tile > LASTRAIL)
-	{
-		return false;
-	}
 
-	if ((tile >= POWERBASE) && (tile < RAILHPOWERV))
+bool tileIsRoad(const TileMap& map, const Point<int> coordinates)
+{
+	if (!CoordinatesValid(coordinates))
 	{
 		return false;
 	}
 
-	return true;
+	return tileProperties(map[coordinates.x][coordinates.y]).has(TileProperties::Drivable);
 }
 
 bool blink()
@@ -124,10 +119,16 @@ bool blink()
 }
 
 
+void DrawBigMapSegment(const Point<int>& begin, const Point<int>& end)
+{
+	DrawBigMapSegment(Map, begin, end);
+}
+
+
 /**
  * Assumes \c begin and \c end are in a valid range
  */
-void DrawBigMapSegment(const Point<int>& begin, const Point<int>& end)
+void DrawBigMapSegment(const TileMap& map, const Point<int>& begin, const Point<int>& end)
 {
 	SDL_SetRenderTarget(MainWindowRenderer, MainMapTexture.texture);
 
@@ -138,7 +139,7 @@ void DrawBigMapSegment(const Point<int>& begin, const Point<int>& end)
 	{
 		for (int col = begin.y; col < end.y; col++)
 		{
-			tile = tileValue(row, col);
+			tile = map[row][col];
 			// Blink lightning bolt in unpowered zone center
 			if (blink() && tileIsZoned(tile) && !tilePowered(tile))
 			{
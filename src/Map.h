@@ -15,6 +15,7 @@
 #include "Point.h"
 #include "Vector.h"
 
+#include <algorithm>
 #include <array>
 
 
@@ -161,9 +162,101 @@ constexpr auto VBRDG3 = 951;
 constexpr auto TILE_COUNT = 960;
 
 
-extern std::array<std::array<int, SimHeight>, SimWidth> Map; // Main Map 120 x 100
+using TileMap = std::array<std::array<int, SimHeight>, SimWidth>;
+
+extern TileMap Map; // Main Map 120 x 100
+
+
+/**
+ * Offsets of the four tiles sharing an edge with a tile, clockwise
+ * starting with the one above.
+ */
+constexpr std::array<Vector<int>, 4> NeighborOffsets
+{ {
+	{  0, -1 },
+	{  1,  0 },
+	{  0,  1 },
+	{ -1,  0 }
+} };
+
+
+/**
+ * Calls \c function with every location from \c begin up to \c end.
+ *
+ * A TileMap holds a column at a time so locations are visited column
+ * by column, which walks the tiles in the order they're stored.
+ */
+template <typename Function>
+void forEachTile(const Point<int>& begin, const Point<int>& end, Function&& function)
+{
+	for (int x = begin.x; x < end.x; ++x)
+	{
+		for (int y = begin.y; y < end.y; ++y)
+		{
+			function(Point<int>{ x, y });
+		}
+	}
+}
+
+
+template <typename Function>
+void forEachTile(Function&& function)
+{
+	forEachTile({ 0, 0 }, { SimWidth, SimHeight }, function);
+}
+
+
+/**
+ * Calls \c function with the first location and the one past the
+ * last of each square block of \c size tiles, column by column.
+ * Blocks along the right and bottom edges are cut short by the map.
+ */
+template <typename Function>
+void forEachBlock(const int size, Function&& function)
+{
+	for (int x = 0; x < SimWidth; x += size)
+	{
+		for (int y = 0; y < SimHeight; y += size)
+		{
+			function(Point<int>{ x, y }, Point<int>{ std::min(x + size, SimWidth), std::min(y + size, SimHeight) });
+		}
+	}
+}
+
+
+/**
+ * Calls \c function with \c location moved by each of \c offsets in
+ * turn, along with the offset's index, whether or not that's on the
+ * map. For passes that count every direction, e.g. to build a bit mask.
+ */
+template <typename Offsets, typename Function>
+void forEachOffset(const Point<int>& location, const Offsets& offsets, Function&& function)
+{
+	for (int index = 0; index < static_cast<int>(offsets.size()); ++index)
+	{
+		function(location + offsets[index], index);
+	}
+}
+
+
+/**
+ * Calls \c function with each neighbour of \c location that's on the
+ * map along with its index in \c NeighborOffsets.
+ */
+template <typename Function>
+void forEachNeighbor(const Point<int>& location, Function&& function)
+{
+	forEachOffset(location, NeighborOffsets, [&function](const Point<int>& neighbor, const int direction)
+	{
+		if (neighbor.x >= 0 && neighbor.x < SimWidth && neighbor.y >= 0 && neighbor.y < SimHeight)
+		{
+			function(neighbor, direction);
+		}
+	});
+}
 
 void DrawBigMapSegment(const Point<int>& begin, const Point<int>& end);
+void DrawBigMapSegment(const TileMap& map, const Point<int>& begin, const Point<int>& end);
 void DrawBigMap();
 
 int& tileValue(const Point<int>& location);
@@ -177,6 +270,7 @@ bool tilePowered(const unsigned int tile);
 bool tileIsZoned(const unsigned int tile);
 
 bool tileIsRoad(const Point<int> coordinates);
+bool tileIsRoad(const TileMap& map, const Point<int> coordinates);
 
 bool blink();
 void ResetMap();
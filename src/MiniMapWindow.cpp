@@ -256,6 +256,12 @@ void MiniMapWindow::linkEffectMap(ButtonId id, const EffectMap& map)
 }
 
 
+void MiniMapWindow::linkTileMap(const TileMap& map)
+{
+    mTileMap = &map;
+}
+
+
 void MiniMapWindow::initTexture(Texture& texture, const Vector<int>& dimensions)
 {
     texture.texture = SDL_CreateTexture(mRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, dimensions.x, dimensions.y);
@@ -344,7 +350,7 @@ void MiniMapWindow::drawPlainMap()
         for (int col = 0; col < mMapSize.y; col++)
         {
             miniMapDrawRect = { row * MiniTileSize, col * MiniTileSize, miniMapDrawRect.w, miniMapDrawRect.h };
-            mTileRect.y = maskedTileValue(tileValue(row, col)) * MiniTileSize;
+            mTileRect.y = maskedTileValue((*mTileMap)[row][col]) * MiniTileSize;
             SDL_RenderCopy(mRenderer, mTiles.texture, &mTileRect, &miniMapDrawRect);
         }
     }
@@ -366,7 +372,7 @@ void MiniMapWindow::drawResidential()
         {
             miniMapDrawRect = { row * MiniTileSize, col * MiniTileSize, miniMapDrawRect.w, miniMapDrawRect.h };
 
-            unsigned int tile = maskedTileValue(row, col);
+            unsigned int tile = maskedTileValue((*mTileMap)[row][col]);
 
             if (tile > 422)
             {
@@ -394,7 +400,7 @@ void MiniMapWindow::drawCommercial()
         {
             miniMapDrawRect = { row * MiniTileSize, col * MiniTileSize, miniMapDrawRect.w, miniMapDrawRect.h };
 
-            unsigned int tile = maskedTileValue(row, col);
+            unsigned int tile = maskedTileValue((*mTileMap)[row][col]);
 
             if ((tile > 609) || ((tile >= 232) && (tile < 423)))
             {
@@ -422,7 +428,7 @@ void MiniMapWindow::drawIndustrial()
         {
             miniMapDrawRect = { row * MiniTileSize, col * MiniTileSize, miniMapDrawRect.w, miniMapDrawRect.h };
 
-            unsigned int tile = maskedTileValue(row, col);
+            unsigned int tile = maskedTileValue((*mTileMap)[row][col]);
 
             if (((tile >= 240) && (tile <= 611)) ||
                 ((tile >= 693) && (tile <= 851)) ||
@@ -454,7 +460,7 @@ void MiniMapWindow::drawPowerMap()
         {
             miniMapDrawRect = { row * MiniTileSize, col * MiniTileSize, miniMapDrawRect.w, miniMapDrawRect.h };
 
-            const unsigned int unmaskedTile = tileValue(row, col);
+            const unsigned int unmaskedTile = (*mTileMap)[row][col];
             unsigned int tile = maskedTileValue(unmaskedTile);
 
             bool colored{ true };
@@ -487,7 +493,7 @@ void MiniMapWindow::drawPowerMap()
             }
             else
             {
-                mTileRect.y = maskedTileValue(tileValue(row, col)) * MiniTileSize;
+                mTileRect.y = maskedTileValue((*mTileMap)[row][col]) * MiniTileSize;
                 SDL_RenderCopy(mRenderer, mTiles.texture, &mTileRect, &miniMapDrawRect);
             }
         }
@@ -509,7 +515,7 @@ void MiniMapWindow::drawLilTransMap()
         {
             miniMapDrawRect = { row * MiniTileSize, col * MiniTileSize, miniMapDrawRect.w, miniMapDrawRect.h };
 
-            unsigned int tile = maskedTileValue(row, col);
+            unsigned int tile = maskedTileValue((*mTileMap)[row][col]);
 
             if ((tile >= ResidentialBase) ||
                 ((tile >= BRWXXX7) && tile <= 220) ||
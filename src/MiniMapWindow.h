@@ -10,6 +10,7 @@
 // file, included in this distribution, for details.
 #pragma once
 
+#include "Map.h"
 #include "Point.h"
 #include "Texture.h"
 #include "Vector.h"
@@ -72,6 +73,7 @@ public:
 	void updateTilePointedAt(const Point<int>& tilePointedAt);
 
 	void linkEffectMap(ButtonId id, const EffectMap& map);
+	void linkTileMap(const TileMap& map);
 
 	void resetOverlayButtons();
 
@@ -140,6 +142,7 @@ private:
 
 	std::map<ButtonId, Texture> mOverlayTextures;
 	std::map<ButtonId, const EffectMap*> mEffectMaps;
+	const TileMap* mTileMap{ &Map };
 
 	std::vector<fnPointIntParam> mFocusOnTileCallbacks;
 
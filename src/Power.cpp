@@ -11,6 +11,9 @@
 #include "main.h"
 
 #include "Map.h"
+#include "Power.h"
+#include "ResumablePass.h"
+#include "Scan.h"
 
 #include "s_alloc.h"
 #include "s_msg.h"
@@ -24,12 +27,13 @@ namespace
     constexpr int CoalPowerProvided{ 700 };
     constexpr int NuclearPowerProvided{ 2000 };
 
-    constexpr auto PowerMapRow = ((SimWidth + 15) / 16);
-    constexpr auto PowerMapSize = (PowerMapRow * SimHeight);
     constexpr auto PowerStackSize = ((SimWidth * SimHeight) / 4);
 
     std::stack<Point<int>> PowerStack;
-    std::array<int, PowerMapSize> PowerMap{};
+    PowerMapWords PowerMap{};
+
+    int PowerAvailable{};
+    int PowerConsumed{};
 
     const Point<int>& topPowerStack()
     {
@@ -72,6 +76,47 @@ void resetPowerMap()
 }
 
 
+const PowerMapWords& powerMap()
+{
+    return PowerMap;
+}
+
+
+void powerMap(const PowerMapWords& words)
+{
+    PowerMap = words;
+}
+
+
+/**
+ * Power plants found so far this cycle, bottom of the stack first.
+ */
+std::vector<Point<int>> powerStack()
+{
+    auto stack = PowerStack;
+
+    std::vector<Point<int>> locations(stack.size());
+    for (auto location = locations.rbegin(); location != locations.rend(); ++location)
+    {
+        *location = stack.top();
+        stack.pop();
+    }
+
+    return locations;
+}
+
+
+void powerStack(const std::vector<Point<int>>& locations)
+{
+    resetPowerStack();
+
+    for (const auto& location : locations)
+    {
+        pushPowerStack(location);
+    }
+}
+
+
 void setPowerBit(const Point<int>& location)
 {
     /* XXX: assumes 120x100 */
@@ -125,46 +170,90 @@ bool isTileConductive(SearchDirection direction)
 }
 
 
-void powerScan()
+void beginPowerScan(int coalPlants, int nuclearPlants)
 {
     resetPowerMap();
 
-    int powerAvailable = (CoalPop * CoalPowerProvided) + (NuclearPop * NuclearPowerProvided);
-    int powerConsumed = 0;
+    PowerAvailable = (coalPlants * CoalPowerProvided) + (nuclearPlants * NuclearPowerProvided);
+    PowerConsumed = 0;
+}
+
+
+/**
+ * Follows the conductive tiles from the top of the power stack.
+ *
+ * \return True if there's more to trace.
+ */
+bool tracePowerStack()
+{
+    if (PowerStack.empty())
+    {
+        return false;
+    }
+
+    SimulationTarget = topPowerStack();
+    popPowerStack();
 
     int conductiveTileCount{};
-    while (!PowerStack.empty())
+    int ADir{ 4 };
+    do
     {
-        SimulationTarget = topPowerStack();
-        popPowerStack();
+        if (++PowerConsumed > PowerAvailable)
+        {
+            SendMes(NotificationId::BrownoutsReported);
+            return false;
+        }
 
-        int ADir{ 4 };
-        do
+        moveSimulationTarget(static_cast<SearchDirection>(ADir));
+        setPowerBit(SimulationTarget);
+
+        conductiveTileCount = 0;
+        int searchDirection{ 0 };
+        while ((searchDirection < 4) && (conductiveTileCount < 2))
         {
-            if (++powerConsumed > powerAvailable)
+            if (isTileConductive(static_cast<SearchDirection>(searchDirection)))
             {
-                SendMes(NotificationId::BrownoutsReported);
-                return;
+                conductiveTileCount++;
+                ADir = searchDirection;
             }
+            searchDirection++;
+        }
+        if (conductiveTileCount > 1)
+        {
+            pushPowerStack(SimulationTarget);
+        }
+    } while (conductiveTileCount);
 
-            moveSimulationTarget(static_cast<SearchDirection>(ADir));
-            setPowerBit(SimulationTarget);
+    return !PowerStack.empty();
+}
 
-            conductiveTileCount = 0;
-            int searchDirection{ 0 };
-            while ((searchDirection < 4) && (conductiveTileCount < 2))
-            {
-                if (isTileConductive(static_cast<SearchDirection>(searchDirection)))
-                {
-                    conductiveTileCount++;
-                    ADir = searchDirection;
-                }
-                searchDirection++;
-            }
-            if (conductiveTileCount > 1)
-            {
-                pushPowerStack(SimulationTarget);
-            }
-        } while (conductiveTileCount);
-    }
+
+void powerScan()
+{
+    powerScan(CoalPop, NuclearPop);
+}
+
+
+/**
+ * Plant counts are passed in so the scan can run on a thread
+ * other than the one that took the census.
+ */
+void powerScan(int coalPlants, int nuclearPlants)
+{
+    beginPowerScan(coalPlants, nuclearPlants);
+    while (tracePowerStack());
+}
+
+
+/**
+ * Traces one entry of the power stack at a time.
+ */
+ResumablePass powerScanPass()
+{
+    ResumablePass pass;
+
+    pass.stage([] { beginPowerScan(CoalPop, NuclearPop); })
+        .repeat(tracePowerStack);
+
+    return pass;
 }
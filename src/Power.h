@@ -11,9 +11,21 @@
 #pragma once
 
 #include <array>
+#include <vector>
 
 #include "main.h"
 
+constexpr auto PowerMapRow = ((SimWidth + 15) / 16);
+constexpr auto PowerMapSize = (PowerMapRow * SimHeight);
+
+using PowerMapWords = std::array<int, PowerMapSize>;
+
+const PowerMapWords& powerMap();
+void powerMap(const PowerMapWords& words);
+
+std::vector<Point<int>> powerStack();
+void powerStack(const std::vector<Point<int>>& locations);
+
 void resetPowerStack();
 void resetPowerMap();
 void pushPowerStack(const Point<int>& location);
@@ -0,0 +1,104 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#include "ResumablePass.h"
+
+
+/**
+ * Adds a stage that is done in one go.
+ */
+ResumablePass& ResumablePass::stage(std::function<void()> step)
+{
+    mStages.push_back([step](int)
+    {
+        step();
+        return false;
+    });
+
+    return *this;
+}
+
+
+/**
+ * Adds a stage of \c count units, \c step is called with each index
+ * from 0 to \c count - 1.
+ */
+ResumablePass& ResumablePass::stage(int count, std::function<void(int)> step)
+{
+    mStages.push_back([count, step](int index)
+    {
+        step(index);
+        return index + 1 < count;
+    });
+
+    return *this;
+}
+
+
+/**
+ * Adds a stage that calls \c step until it returns false.
+ */
+ResumablePass& ResumablePass::repeat(std::function<bool()> step)
+{
+    mStages.push_back([step](int)
+    {
+        return step();
+    });
+
+    return *this;
+}
+
+
+ResumablePass& ResumablePass::then(const ResumablePass& pass)
+{
+    mStages.insert(mStages.end(), pass.mStages.begin(), pass.mStages.end());
+    return *this;
+}
+
+
+/**
+ * Runs units until the pass is done or \c slice expires. At least one
+ * unit runs per call so a pass always makes progress.
+ *
+ * \return True once the pass is done. The next call starts it over.
+ */
+bool ResumablePass::run(const TimeSlice& slice)
+{
+    bool ranUnit{ false };
+
+    while (mStage < mStages.size())
+    {
+        if (ranUnit && slice.expired())
+        {
+            return false;
+        }
+
+        const bool more = mStages[mStage](mIndex);
+        ranUnit = true;
+
+        if (more)
+        {
+            ++mIndex;
+            continue;
+        }
+
+        ++mStage;
+        mIndex = 0;
+    }
+
+    mStage = 0;
+    return true;
+}
+
+
+void ResumablePass::run()
+{
+    run(TimeSlice{});
+}
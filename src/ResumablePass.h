@@ -0,0 +1,50 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#pragma once
+
+#include "TimeSlice.h"
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+
+/**
+ * Work split into stages of small units so it can stop when its time
+ * slice runs out and carry on from the same unit on the next call.
+ *
+ * Units run in the same order no matter how the work is sliced, so a
+ * sliced pass gives the same results as one run in a single go.
+ */
+class ResumablePass
+{
+public:
+	ResumablePass() = default;
+
+	ResumablePass& stage(std::function<void()> step);
+	ResumablePass& stage(int count, std::function<void(int)> step);
+	ResumablePass& repeat(std::function<bool()> step);
+	ResumablePass& then(const ResumablePass& pass);
+
+	bool run(const TimeSlice& slice);
+	void run();
+
+	bool inProgress() const { return mStage > 0 || mIndex > 0; }
+
+private:
+	// Runs unit \c index of a stage and returns true if there are more.
+	using Unit = std::function<bool(int)>;
+
+	std::vector<Unit> mStages;
+
+	std::size_t mStage{ 0 };
+	int mIndex{ 0 };
+};
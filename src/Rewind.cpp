@@ -0,0 +1,132 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#include "Rewind.h"
+
+#include "main.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+
+namespace
+{
+    constexpr int MonthLength{ 4 }; // in CityTime
+};
+
+
+Rewind::Rewind(std::size_t years):
+    mCapacity((years > 0 ? years : 1) * MonthsPerKeyframe),
+    mCity(std::make_unique<SavedCity>()),
+    mPrevious(std::make_unique<SavedCity>())
+{}
+
+
+/**
+ * Call after every simulation frame, takes a snapshot whenever a
+ * new month has started.
+ */
+void Rewind::capture(const CityProperties& properties, const Budget& budget)
+{
+    const int month = CityTime / MonthLength;
+    if (month == mLastMonth)
+    {
+        return;
+    }
+
+    mLastMonth = month;
+
+    if (!mSnapshots.empty())
+    {
+        mSnapshots.resize(mPosition + 1);
+    }
+
+    std::size_t sinceKeyframe{ 0 };
+    while (sinceKeyframe < mSnapshots.size() && !mSnapshots[mSnapshots.size() - 1 - sinceKeyframe].change.complete)
+    {
+        ++sinceKeyframe;
+    }
+
+    const bool keyframe = mSnapshots.empty() || sinceKeyframe + 1 >= MonthsPerKeyframe;
+
+    captureCity(*mCity, properties, budget);
+    mSnapshots.push_back({ CityTime, encodeCityChange(keyframe ? nullptr : mPrevious.get(), *mCity) });
+    std::swap(mCity, mPrevious);
+
+    // Drop the oldest year whole, its months can't be decoded without it.
+    while (mSnapshots.size() > mCapacity)
+    {
+        mSnapshots.pop_front();
+        while (!mSnapshots.front().change.complete)
+        {
+            mSnapshots.pop_front();
+        }
+    }
+
+    mPosition = mSnapshots.size() - 1;
+}
+
+
+/**
+ * Loads snapshot \c index, oldest first. Later snapshots are kept
+ * until the next one is captured so they can still be scrubbed to.
+ */
+bool Rewind::restore(std::size_t index, CityProperties& properties, Budget& budget)
+{
+    if (index >= mSnapshots.size())
+    {
+        return false;
+    }
+
+    try
+    {
+        decode(index, *mPrevious);
+    }
+    catch (const std::runtime_error& error)
+    {
+        std::cout << error.what() << std::endl;
+        clear();
+        return false;
+    }
+
+    restoreCity(*mPrevious, properties, budget);
+
+    mPosition = index;
+    mLastMonth = CityTime / MonthLength;
+
+    return true;
+}
+
+
+void Rewind::clear()
+{
+    mSnapshots.clear();
+    mPosition = 0;
+    mLastMonth = -1;
+}
+
+
+/**
+ * Rebuilds snapshot \c index from the keyframe before it.
+ */
+void Rewind::decode(std::size_t index, SavedCity& city) const
+{
+    std::size_t keyframe = index;
+    while (!mSnapshots[keyframe].change.complete)
+    {
+        --keyframe;
+    }
+
+    for (std::size_t i = keyframe; i <= index; ++i)
+    {
+        applyCityChange(mSnapshots[i].change, city);
+    }
+}
@@ -0,0 +1,73 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#pragma once
+
+#include "s_fileio.h"
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+
+class Budget;
+class CityProperties;
+
+
+/**
+ * The last few years of a city, one snapshot per simulated month,
+ * for scrubbing back through.
+ *
+ * Every twelfth snapshot holds the whole city and the rest only how
+ * it differs from the month before, which is mostly a few hundred
+ * tiles, so a month costs a few kilobytes. The oldest year is
+ * dropped once the limit is reached.
+ *
+ * Restoring a snapshot starts the simulation on it the way loading
+ * a save does. Carrying on from there drops every later snapshot.
+ */
+class Rewind
+{
+public:
+	Rewind() = delete;
+	Rewind(const Rewind&) = delete;
+	const Rewind& operator=(const Rewind&) = delete;
+
+	explicit Rewind(std::size_t years);
+
+	void capture(const CityProperties&, const Budget&);
+
+	std::size_t size() const { return mSnapshots.size(); }
+	std::size_t position() const { return mPosition; }
+	int cityTime(std::size_t index) const { return mSnapshots.at(index).cityTime; }
+
+	bool restore(std::size_t index, CityProperties&, Budget&);
+	void clear();
+
+private:
+	static constexpr std::size_t MonthsPerKeyframe{ 12 };
+
+	struct Snapshot
+	{
+		int cityTime{};
+		CityChange change;
+	};
+
+	void decode(std::size_t index, SavedCity& city) const;
+
+	const std::size_t mCapacity;
+
+	std::deque<Snapshot> mSnapshots;
+
+	std::unique_ptr<SavedCity> mCity;
+	std::unique_ptr<SavedCity> mPrevious; // city as of the snapshot at mPosition
+
+	std::size_t mPosition{ 0 };
+	int mLastMonth{ -1 };
+};
@@ -11,7 +11,9 @@
 #include "Scan.h"
 
 #include "EffectMap.h"
+#include "ResumablePass.h"
 #include "Map.h"
+#include "TileProperties.h"
 #include "Vector.h"
 #include "Zone.h"
 
@@ -21,6 +23,12 @@
 #include "w_util.h"
 
 #include <algorithm>
+#include <array>
+#include <cstdlib>
+
+
+int getPopulationDensity(int tile);
+void smoothTerrain(const Point<int>& begin, const Point<int>& end);
 
 
 namespace
@@ -37,190 +45,276 @@ namespace
 
     EffectMap Qtem({ QuarterWorldWidth, QuarterWorldHeight });
 
+    /**
+     * The pollution scan works on blocks of BlockSize tiles on a side.
+     * It keeps the tiles each block had when its cells were last
+     * summed up and only sums them up again once those tiles change.
+     */
+    constexpr int BlockSize{ 8 };
+    constexpr int BlockColumns{ (SimWidth + BlockSize - 1) / BlockSize };
+    constexpr int BlockRows{ (SimHeight + BlockSize - 1) / BlockSize };
 
-    int getPollutionValue(int tileValue)
-    {
-        if (tileValue < POWERBASE)
-        {
-            if (tileValue >= HTRFBASE) /* heavy traf  */
-            {
-                return (/* 25 */ 75);
-            }
+    TileMap PollutionScanTiles{};
 
-            if (tileValue >= LTRFBASE) /* light traf  */
-            {
-                return (/* 10 */ 50);
-            }
+    std::array<CellSummary, HalfWorldWidth * HalfWorldHeight> CellSummaries{};
+    std::array<bool, BlockColumns * BlockRows> PollutionBlockChanged{};
 
-            if (tileValue < ROADBASE)
-            {
-                if (tileValue > FIREBASE)
-                {
-                    return (/* 60 */ 90);
-                }
+    // Totals kept between the units of a pass
+    int HighestPollution{};
+    int PollutedTileCount{};
+    int PollutionTotal{};
 
-                /* XXX: Why negative pollution from radiation? */
-                if (tileValue >= RADTILE) /* radioactivity  */
-                {
-                    return (/* -40 */ 255);
-                }
-            }
-            return 0;
-        }
+    int LandValueTotal{};
+    int LandValueCount{};
 
-        if (tileValue <= LASTIND)
-        {
-            return (0);
-        }
+    int HighestCrime{};
+    int CrimeTotal{};
+    int CrimeZoneCount{};
+
+    Vector<int> ZoneAxisTotal{};
+    int ZoneCount{};
 
-        if (tileValue < PORTBASE) /* Ind  */
-        {
-            return (50);
-        }
 
-        if (tileValue <= LASTPOWERPLANT) /* prt, aprt, cpp */
+    /**
+     * Distance from each half resolution cell to \c center, which is
+     * in tile coords.
+     */
+    EffectMap cityCenterDistances(const Point<int>& center)
+    {
+        const Vector<int> radius = { center.x / 2, center.y / 2 };
+
+        EffectMap distances({ HalfWorldWidth, HalfWorldHeight });
+        distances.forEachCell([&](const Point<int>& coord)
         {
-            return (/* 60 */ 100);
-        }
+            const int distance = std::abs(coord.x - radius.x) + std::abs(coord.y - radius.y);
+            distances.value(coord) = std::min(distance, 32); // fixme: magic number
+        });
 
-        return 0;
+        return distances;
     }
 
 
-    int distanceToCityCenter(int x, int y)
-    {
-        const Vector<int> radius = { CityCenter.x / 2, (CityCenter.y / 2) };
+    // Only worked out again when the centre moves
+    EffectMap CityCenterDistance{ cityCenterDistances(CityCenter) };
 
-        Vector<int> distance{};
-        if (x > radius.x)
-        {
-            distance.x = x - radius.x;
-        }
-        else
-        {
-            distance.x = radius.x - x;
-        }
 
-        if (y > radius.y)
-        {
-            distance.y = y - radius.y;
-        }
-        else
+    void cityCenter(const Point<int>& center)
+    {
+        if (center != CityCenter)
         {
-            distance.y = radius.y - y;
+            CityCenter = center;
+            CityCenterDistance = cityCenterDistances(center);
         }
+    }
 
-        int totalDistance = (distance.x + distance.y);
-        if (totalDistance > 32) // fixme: magic number
-        {
-            return 32;
-        }
 
-        return totalDistance;
+    CellSummary& cellSummary(const Point<int>& point)
+    {
+        return CellSummaries[(point.y * HalfWorldWidth) + point.x];
     }
 
 
-    int pollutionLevel(const Point<int>& point)
+    /**
+     * Sums up the four tiles of a half resolution cell and adds its
+     * water and trees to the terrain count.
+     */
+    CellSummary summarizeCell(const Point<int>& point)
     {
+        CellSummary summary;
+
         int pollutionLevel{};
-        for (int xx = (point.x * 2); xx <= (point.x * 2) + 1; ++xx)
+        const Point<int> first{ point.x * 2, point.y * 2 };
+        forEachTile(first, first + Vector<int>{ 2, 2 }, [&](const Point<int>& location)
         {
-            for (int yy = (point.y * 2); yy <= (point.y * 2) + 1; ++yy)
+            const int tile = (Map[location.x][location.y] & LOMASK);
+            summary.developedTiles += (tile >= ROADBASE) ? 1 : 0;
+            summary.lastTileDeveloped = (tile >= ROADBASE);
+
+            if (tile)
             {
-                const int tile = (Map[xx][yy] & LOMASK);
-                if (tile)
+                const auto& properties = tileProperties(tile);
+                if (properties.tileClass < TileClass::Rubble)
                 {
-                    if (tile < RUBBLE)
-                    {
-                        /* inc terrainMem */
-                        Qtem.value({ point.x / 2, point.y / 2 }) += 15;
-                        continue;
-                    }
-
-                    pollutionLevel += getPollutionValue(tile);
+                    /* inc terrainMem */
+                    Qtem.value({ point.x / 2, point.y / 2 }) += 15;
+                    return;
                 }
+
+                pollutionLevel += properties.pollution;
             }
-        }
+        });
 
-        return std::clamp(pollutionLevel, 0, 255);
+        summary.pollution = std::clamp(pollutionLevel, 0, 255);
+        return summary;
     }
 
 
-    void setMostPollutedLocation()
+    /**
+     * One column of the half resolution pollution map.
+     */
+    void setMostPollutedLocation(int x)
     {
-        int highestPollution{ 0 };
-        int pollutedTileCount{ 0 };
-        int pollutionTotal{ 0 };
-
-        for (int x = 0; x < HalfWorldWidth; ++x)
+        tem.forEachCell({ x, 0 }, { x + 1, HalfWorldHeight }, [](const Point<int>& coord)
         {
-            for (int y = 0; y < HalfWorldHeight; ++y)
+            const int pollutionValue = tem.value(coord);
+            PollutionMap.value(coord) = pollutionValue;
+
+            if (pollutionValue) /*  get pollute average  */
             {
-                const int pollutionValue = tem.value({ x, y });
-                PollutionMap.value({ x, y }) = pollutionValue;
+                PollutedTileCount++;
+                PollutionTotal += pollutionValue;
 
-                if (pollutionValue) /*  get pollute average  */
+                /* find max pol for monster  */
+                if ((pollutionValue > HighestPollution) || ((pollutionValue == HighestPollution) && (!(Rand16() & 3))))
                 {
-                    pollutedTileCount++;
-                    pollutionTotal += pollutionValue;
-
-                    /* find max pol for monster  */
-                    if ((pollutionValue > highestPollution) || ((pollutionValue == highestPollution) && (!(Rand16() & 3))))
-                    {
-                        highestPollution = pollutionValue;
-                        PollutionMax = { x * 2, y * 2 };
-                    }
+                    HighestPollution = pollutionValue;
+                    PollutionMax = { coord.x * 2, coord.y * 2 };
                 }
             }
-        }
+        });
+    }
 
-        PolluteAverage = pollutedTileCount ? pollutionTotal / pollutedTileCount : 0;
+
+    /**
+     * Copies the tiles from \c begin up to \c end into the pollution
+     * scan's copy of the map. Returns true if any of them changed.
+     */
+    bool updatePollutionScanTiles(const Point<int>& begin, const Point<int>& end)
+    {
+        bool changed{ false };
+
+        forEachTile(begin, end, [&changed](const Point<int>& location)
+        {
+            const int tile = Map[location.x][location.y] & LOMASK;
+            changed |= (tile != PollutionScanTiles[location.x][location.y]);
+            PollutionScanTiles[location.x][location.y] = tile;
+        });
+
+        return changed;
     }
 
 
-    void pollutionScan()
+    /**
+     * One row of blocks of the half resolution pollution map. This is
+     * the only part of the pass that reads the tiles.
+     */
+    void pollutionScanBlockRow(int row)
     {
-        for (int i{}; i < HalfWorldWidth * HalfWorldHeight; ++i)
+        for (int column{}; column < BlockColumns; ++column)
         {
-            const Point<int> coord{ i % HalfWorldWidth, i / HalfWorldWidth };
-            tem.value(coord) = pollutionLevel(coord);
+            const Point<int> begin{ column * BlockSize, row * BlockSize };
+            const Point<int> end{ std::min(begin.x + BlockSize, SimWidth), std::min(begin.y + BlockSize, SimHeight) };
+
+            const bool changed = updatePollutionScanTiles(begin, end);
+            PollutionBlockChanged[(row * BlockColumns) + column] = changed;
+
+            if (changed)
+            {
+                Qtem.forEachCell({ begin.x / 4, begin.y / 4 }, { end.x / 4, end.y / 4 }, [](const Point<int>& coord)
+                {
+                    Qtem.value(coord) = 0;
+                });
+            }
+
+            tem.forEachCell({ begin.x / 2, begin.y / 2 }, { end.x / 2, end.y / 2 }, [changed](const Point<int>& coord)
+            {
+                if (changed)
+                {
+                    cellSummary(coord) = summarizeCell(coord);
+                }
+
+                tem.value(coord) = cellSummary(coord).pollution;
+            });
         }
     }
 
 
-    void landValueScan()
+    /**
+     * One column of the half resolution land value map. Every developed
+     * tile of a cell counts towards the average.
+     */
+    void landValueScanColumn(int x)
     {
-        int LVtot = 0;
-        int LVnum = 0;
-        for (int x{}; x < SimWidth * SimHeight; ++x)
+        LandValueMap.forEachCell({ x, 0 }, { x + 1, HalfWorldHeight }, [](const Point<int>& coord)
         {
-
-            const Point<int> coord{ x % SimWidth, x / SimWidth };
-            const auto tile = maskedTileValue(coord.x, coord.y);
-            if (tile < ROADBASE)
+            const auto& summary = cellSummary(coord);
+            if (summary.developedTiles == 0)
             {
-                LandValueMap.value(coord.skewInverseBy({ 2, 2 })) = 0;
-                continue;
+                LandValueMap.value(coord) = 0;
+                return;
             }
 
-            int dis = 34 - distanceToCityCenter(coord.x / 2, coord.y / 2);
+            int dis = 34 - CityCenterDistance.value(coord);
             dis = dis * 4;
-            dis += TerrainMem.value(coord.skewInverseBy({ 4, 4 }));
-            dis -= PollutionMap.value(coord.skewInverseBy({ 2, 2 }));
+            dis += TerrainMem.value(coord.skewInverseBy({ 2, 2 }));
+            dis -= PollutionMap.value(coord);
 
-            if (CrimeMap.value(coord.skewInverseBy({ 2, 2 })) > 190)
+            if (CrimeMap.value(coord) > 190)
             {
                 dis -= 20;
             }
 
             dis = std::clamp(dis, 1, 250);
 
-            LandValueMap.value(coord.skewInverseBy({ 2, 2 })) = dis;
-            LVtot += dis;
-            LVnum++;
-        }
+            LandValueMap.value(coord) = summary.lastTileDeveloped ? dis : 0;
+            LandValueTotal += dis * summary.developedTiles;
+            LandValueCount += summary.developedTiles;
+        });
+    }
+
+
+    /**
+     * One column of the half resolution crime map.
+     */
+    void crimeScanColumn(int x)
+    {
+        CrimeMap.forEachCell({ x, 0 }, { x + 1, HalfWorldHeight }, [](const Point<int>& coord)
+        {
+            int landValue = LandValueMap.value(coord);
+            if (landValue == 0)
+            {
+                CrimeMap.value(coord) = 0;
+                return;
+            }
+
+            ++CrimeZoneCount;
+
+            landValue = 128 - landValue;
+            landValue = std::clamp(landValue + PopulationDensityMap.value(coord), 0, 300);
+            landValue = std::clamp(landValue - PoliceStationMap.value({ coord.x / 4, coord.y / 4 }), 0, 250);
+
+            CrimeMap.value(coord) = landValue;
+            CrimeTotal += landValue;
+
+            if ((landValue > HighestCrime) || ((landValue == HighestCrime) && (!(Rand16() & 3))))
+            {
+                HighestCrime = landValue;
+                CrimeMax = { coord.x * 2, coord.y * 2 };
+            }
+        });
+    }
+
+
+    /**
+     * The zones in one column of the map.
+     */
+    void populationDensityColumn(int x)
+    {
+        for (auto zone = Zones.firstInColumn(x); (zone < Zones.size()) && (Zones.location(zone).x == x); ++zone)
+        {
+            const auto location = Zones.location(zone);
 
-        LVAverage = LVnum ? LVtot / LVnum : 0;
+            int tile = tileValue(location);
+            if (!Zones.removed(zone) && (tile & ZONEBIT))
+            {
+                SimulationTarget = location; // housePopulation() counts around the target
+                tile = tile & LOMASK;
+                tile = std::clamp(getPopulationDensity(tile) * 8, 0, 254);
+                tem.value({ location.x / 2, location.y / 2 }) = tile;
+                ZoneAxisTotal += { location.x, location.y };
+                ZoneCount++;
+            }
+        }
     }
 
 
@@ -259,6 +353,12 @@ const Point<int>& cityCenterOfMass()
 }
 
 
+void cityCenterOfMass(const Point<int>& center)
+{
+    cityCenter(center);
+}
+
+
 bool newMap()
 {
     return NewMap;
@@ -277,20 +377,53 @@ const Point<int>& pollutionMax()
 }
 
 
+void pollutionMax(const Point<int>& location)
+{
+    PollutionMax = location;
+}
+
+
+/**
+ * Forgets which tiles the pollution scan last summed up so its next
+ * pass sums up every block and smooths all of the terrain again. Has
+ * to be called whenever the map or TerrainMem is replaced.
+ */
+void resetPollutionScan()
+{
+    for (auto& column : PollutionScanTiles)
+    {
+        column.fill(-1); // never a masked tile
+    }
+}
+
+
+void capturePollutionScan(PollutionScanCache& cache)
+{
+    cache.tiles = PollutionScanTiles;
+    cache.cells = CellSummaries;
+    cache.terrain = Qtem;
+}
+
+
+void applyPollutionScan(const PollutionScanCache& cache)
+{
+    PollutionScanTiles = cache.tiles;
+    CellSummaries = cache.cells;
+    Qtem = cache.terrain;
+}
+
+
 void smoothStationMap(EffectMap& map)
 {
     EffectMap temp({ map.dimensions().x , map.dimensions().y});
 
-    for (int x = 0; x < map.dimensions().x; x++)
+    map.forEachCell([&](const Point<int>& coord)
     {
-        for (int y = 0; y < map.dimensions().y; y++)
-        {
-            int edge = sumAdjacent({ x, y }, map);
+        int edge = sumAdjacent(coord, map);
 
-            edge = (edge / 4) + map.value({ x, y });
-            temp.value({ x, y }) = edge / 2;
-        }
-    }
+        edge = (edge / 4) + map.value(coord);
+        temp.value(coord) = edge / 2;
+    });
 
     map = temp;
 }
@@ -303,26 +436,55 @@ void smoothEffectMap(const EffectMap& src, EffectMap& dst)
         throw std::runtime_error("smoothEffectMap(): Source and Destination array dimensions do not match.");
     }
 
-    for (int x{}; x < src.dimensions().x; ++x)
+    src.forEachCell([&](const Point<int>& coord)
     {
-        for (int y{}; y < src.dimensions().y; ++y)
-        {
-            const auto val = sumAdjacent({ x, y }, src);
-            dst.value({ x, y }) = std::clamp((val + src.value({ x, y })) / 4, 0, 255);
-        }
-    }
+        const auto val = sumAdjacent(coord, src);
+        dst.value(coord) = std::clamp((val + src.value(coord)) / 4, 0, 255);
+    });
 }
 
 
 void smoothTerrain()
 {
-    for (int x{}; x < QuarterWorldWidth; ++x)
+    smoothTerrain({ 0, 0 }, { QuarterWorldWidth, QuarterWorldHeight });
+}
+
+
+/**
+ * Smooths the terrain from \c begin up to \c end, in quarter
+ * resolution coords.
+ */
+void smoothTerrain(const Point<int>& begin, const Point<int>& end)
+{
+    const Point<int> first{ std::max(begin.x, 0), std::max(begin.y, 0) };
+    const Point<int> last{ std::min(end.x, QuarterWorldWidth), std::min(end.y, QuarterWorldHeight) };
+
+    TerrainMem.forEachCell(first, last, [](const Point<int>& coord)
+    {
+        const int val = Qtem.value(coord);
+        int z = sumAdjacent(coord, Qtem);
+        TerrainMem.value(coord) = (((z / 4) + val) / 2) % 256;
+    });
+}
+
+
+/**
+ * Smooths the terrain of the blocks the last pollution scan found
+ * changed along with the cells bordering them.
+ */
+void smoothChangedTerrain()
+{
+    constexpr int QuarterBlockSize{ BlockSize / 4 };
+
+    for (int row{}; row < BlockRows; ++row)
     {
-        for (int y{}; y < QuarterWorldHeight; ++y)
+        for (int column{}; column < BlockColumns; ++column)
         {
-            const int val = Qtem.value({ x, y });
-            int z = sumAdjacent({ x, y }, Qtem);
-            TerrainMem.value({ x, y }) = (((z / 4) + val) / 2) % 256;
+            if (PollutionBlockChanged[(row * BlockColumns) + column])
+            {
+                const Point<int> begin{ column * QuarterBlockSize, row * QuarterBlockSize };
+                smoothTerrain(begin - Vector<int>{ 1, 1 }, begin + Vector<int>{ QuarterBlockSize + 1, QuarterBlockSize + 1 });
+            }
         }
     }
 }
@@ -333,52 +495,51 @@ void smoothTerrain()
  */
 void fireAnalysis()
 {
-    smoothStationMap(FireStationMap);
-    smoothStationMap(FireStationMap);
-    smoothStationMap(FireStationMap);
+    fireAnalysisPass().run();
+}
+
+
+ResumablePass fireAnalysisPass()
+{
+    ResumablePass pass;
 
-    FireProtectionMap = FireStationMap;
+    pass.stage(3, [](int) { smoothStationMap(FireStationMap); })
+        .stage([] { FireProtectionMap = FireStationMap; });
+
+    return pass;
 }
 
 
 int getPopulationDensity(int tile)
 {
-    if (tile == ResidentialEmpty)
+    const auto& properties = tileProperties(tile);
+
+    if (properties.has(TileProperties::CountsHouses))
     {
         return housePopulation();
     }
 
-    if (tile < COMBASE)
+    switch (properties.tileClass)
     {
-        return residentialZonePopulation(tile);
-    }
+    case TileClass::Commercial:
+    case TileClass::Industrial:
+        return properties.population * 8;
 
-    if (tile < INDBASE)
-    {
-        return commercialZonePopulation(tile) * 8;
+    default:
+        return properties.population;
     }
-
-    if (tile < PORTBASE)
-    {
-        return industrialZonePopulation(tile) * 8;
-    }
-
-    return 0;
 }
 
 
 void distIntMarket()
 {
-    for (int x{}; x < EighthWorldWidth; x++)
+    ComRate.forEachCell([](const Point<int>& coord)
     {
-        for (int y{}; y < EighthWorldHeight; y++)
-        {
-            int z{ distanceToCityCenter(x * 4 , y * 4) };
-            z *= 4;
-            z = 64 - z;
-            ComRate.value({ x, y }) = z;
-        }
-    }
+        int z{ CityCenterDistance.value({ coord.x * 4, coord.y * 4 }) };
+        z *= 4;
+        z = 64 - z;
+        ComRate.value(coord) = z;
+    });
 }
 
 
@@ -387,94 +548,102 @@ void distIntMarket()
  */
 void scanPopulationDensity()
 {
-    tem.reset();
+    populationDensityPass().run();
+}
 
-    Vector<int> axisTotal{};
-    int zoneCount{};
 
-    for (int x{}; x < SimWidth; ++x)
-    {
-        for (int y{}; y < SimHeight; ++y)
+ResumablePass populationDensityPass()
+{
+    ResumablePass pass;
+
+    pass.stage([]
         {
-            int tile = tileValue({ x, y });
-            if (tile & ZONEBIT)
-            {
-                tile = tile & LOMASK;
-                tile = std::clamp(getPopulationDensity(tile) * 8, 0, 254);
-                tem.value({ x / 2, y / 2 }) = tile;
-                axisTotal += { x, y };
-                zoneCount++;
-            }
-        }
-    }
+            tem.reset();
+            ZoneAxisTotal = {};
+            ZoneCount = 0;
+        })
+        .stage(SimWidth, populationDensityColumn)
+        .stage([]
+        {
+            smoothEffectMap(tem, tem2);
+            smoothEffectMap(tem2, tem);
+            smoothEffectMap(tem, tem2);
 
-    smoothEffectMap(tem, tem2);
-    smoothEffectMap(tem2, tem);
-    smoothEffectMap(tem, tem2);
+            PopulationDensityMap = tem2 * 2;
 
-    PopulationDensityMap = tem2 * 2;
+            distIntMarket(); /* set ComRate w/ (/ComMap) */
 
-    distIntMarket(); /* set ComRate w/ (/ComMap) */
+            // Set center of mass for the city
+            cityCenter(ZoneCount ? Point<int>{ ZoneAxisTotal.x / ZoneCount, ZoneAxisTotal.y / ZoneCount } : Point<int>{ HalfWorldWidth, HalfWorldHeight });
+        });
 
-    // Set center of mass for the city
-    zoneCount ? CityCenter = { axisTotal.x / zoneCount, axisTotal.y / zoneCount } : CityCenter = { HalfWorldWidth, HalfWorldHeight };
+    return pass;
 }
 
 
 void pollutionAndLandValueScan()
 {
-    Qtem.fill(0);
+    pollutionAndLandValuePass().run();
+}
+
 
-    pollutionScan();
-    landValueScan();
+ResumablePass pollutionAndLandValuePass()
+{
+    ResumablePass pass;
 
-    smoothEffectMap(tem, tem2);
-    smoothEffectMap(tem2, tem);
+    pass.stage([]
+        {
+            LandValueTotal = 0;
+            LandValueCount = 0;
+        })
+        .stage(BlockRows, pollutionScanBlockRow)
+        .stage(HalfWorldWidth, landValueScanColumn)
+        .stage([]
+        {
+            LVAverage = LandValueCount ? LandValueTotal / LandValueCount : 0;
 
-    setMostPollutedLocation();
+            smoothEffectMap(tem, tem2);
+            smoothEffectMap(tem2, tem);
 
-    smoothTerrain();
+            HighestPollution = 0;
+            PollutedTileCount = 0;
+            PollutionTotal = 0;
+        })
+        .stage(HalfWorldWidth, setMostPollutedLocation)
+        .stage([]
+        {
+            PolluteAverage = PollutedTileCount ? PollutionTotal / PollutedTileCount : 0;
+            smoothChangedTerrain();
+        });
+
+    return pass;
 }
 
 
 void crimeScan()
 {
-    smoothStationMap(PoliceStationMap);
-    smoothStationMap(PoliceStationMap);
-    smoothStationMap(PoliceStationMap);
-
-    int totz{};
-    int numz{};
-    int cmax{};
-    for (int x{}; x < HalfWorldWidth; ++x)
-    {
-        for (int y{}; y < HalfWorldHeight; ++y)
-        {
-            int landValue = LandValueMap.value({ x, y });
-            if (landValue == 0)
-            {
-                CrimeMap.value({ x, y }) = 0;
-                continue;
-            }
-
-            ++numz;
+    crimeScanPass().run();
+}
 
-            landValue = 128 - landValue;
-            landValue = std::clamp(landValue + PopulationDensityMap.value({ x, y }), 0, 300);
-            landValue = std::clamp(landValue - PoliceStationMap.value({ x / 4, y / 4 }), 0, 250);
 
-            CrimeMap.value({ x, y }) = landValue;
-            totz += landValue;
+ResumablePass crimeScanPass()
+{
+    ResumablePass pass;
 
-            if ((landValue > cmax) || ((landValue == cmax) && (!(Rand16() & 3))))
-            {
-                cmax = landValue;
-                CrimeMax = { x * 2, y * 2 };
-            }
-        }
-    }
+    pass.stage(3, [](int) { smoothStationMap(PoliceStationMap); })
+        .stage([]
+        {
+            HighestCrime = 0;
+            CrimeTotal = 0;
+            CrimeZoneCount = 0;
+        })
+        .stage(HalfWorldWidth, crimeScanColumn)
+        .stage([]
+        {
+            (CrimeZoneCount > 0) ? CrimeAverage = (CrimeTotal / CrimeZoneCount) : CrimeAverage = 0;
 
-    (numz > 0) ? CrimeAverage = (totz / numz) : CrimeAverage = 0;
+            PoliceProtectionMap = PoliceStationMap;
+        });
 
-    PoliceProtectionMap = PoliceStationMap;
+    return pass;
 }
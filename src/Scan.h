@@ -12,16 +12,58 @@
 
 #include <array>
 
+#include "EffectMap.h"
+#include "Map.h"
 #include "Point.h"
 
+class ResumablePass;
+
+
+/**
+ * Everything the pollution and land value scan needs from the four
+ * tiles of a half resolution cell, gathered in one read of the map.
+ */
+struct CellSummary
+{
+	int pollution{};
+	int developedTiles{}; // Roads and anything built after them
+	bool lastTileDeveloped{ false }; // Land value was taken from the bottom right tile
+};
+
+
+/**
+ * What the pollution scan keeps between passes so it only sums up
+ * blocks whose tiles changed. It belongs with TerrainMem, whatever
+ * replaces one has to replace or reset the other.
+ */
+struct PollutionScanCache
+{
+	TileMap tiles{};
+	std::array<CellSummary, HalfWorldWidth * HalfWorldHeight> cells{};
+	EffectMap terrain{ Vector<int>{ QuarterWorldWidth, QuarterWorldHeight } };
+};
+
+void resetPollutionScan();
+void capturePollutionScan(PollutionScanCache&);
+void applyPollutionScan(const PollutionScanCache&);
+
 const Point<int>& pollutionMax();
+void pollutionMax(const Point<int>& location);
 void powerScan();
+void powerScan(int coalPlants, int nuclearPlants);
 void pollutionAndLandValueScan();
 void crimeScan();
 void scanPopulationDensity();
 void fireAnalysis();
 
+ResumablePass powerScanPass();
+ResumablePass pollutionAndLandValuePass();
+ResumablePass crimeScanPass();
+ResumablePass populationDensityPass();
+ResumablePass fireAnalysisPass();
+
 bool newMap();
 void newMap(bool value);
 
 const Point<int>& cityCenterOfMass();
+void cityCenterOfMass(const Point<int>& center);
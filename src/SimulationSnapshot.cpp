@@ -0,0 +1,60 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#include "SimulationSnapshot.h"
+
+#include "Budget.h"
+
+#include "main.h"
+#include "s_msg.h"
+#include "w_update.h"
+#include "w_util.h"
+
+
+/**
+ * Copies everything the UI needs into \c snapshot. Buffers are
+ * reused so nothing is allocated once the snapshot has been
+ * filled the first time.
+ */
+void takeSnapshot(SimulationSnapshot& snapshot, const Budget& budget)
+{
+    snapshot.map = Map;
+
+    snapshot.crimeMap = CrimeMap;
+    snapshot.fireProtectionMap = FireProtectionMap;
+    snapshot.landValueMap = LandValueMap;
+    snapshot.policeProtectionMap = PoliceProtectionMap;
+    snapshot.pollutionMap = PollutionMap;
+    snapshot.populationDensityMap = PopulationDensityMap;
+    snapshot.rateOfGrowthMap = RateOfGrowthMap;
+    snapshot.trafficDensityMap = TrafficDensityMap;
+
+    snapshot.residentialHistory = ResHis;
+    snapshot.commercialHistory = ComHis;
+    snapshot.industrialHistory = IndHis;
+    snapshot.moneyHistory = MoneyHis;
+    snapshot.crimeHistory = CrimeHis;
+    snapshot.pollutionHistory = PollutionHis;
+
+    snapshot.sprites = sprites();
+
+    snapshot.message = LastMessage();
+
+    snapshot.residentialValve = RValve;
+    snapshot.commercialValve = CValve;
+    snapshot.industrialValve = IValve;
+
+    snapshot.funds = budget.CurrentFunds();
+    snapshot.month = LastCityMonth();
+    snapshot.year = CurrentYear();
+
+    snapshot.budgetNeedsAttention = budget.NeedsAttention();
+    snapshot.autoBulldoze = AutoBulldoze;
+}
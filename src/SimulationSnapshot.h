@@ -0,0 +1,68 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#pragma once
+
+#include "EffectMap.h"
+#include "Map.h"
+#include "Sprite.h"
+
+#include "s_alloc.h"
+
+#include <string>
+#include <vector>
+
+class Budget;
+
+
+/**
+ * Copy of the simulation state the UI draws from.
+ */
+struct SimulationSnapshot
+{
+	TileMap map{};
+
+	EffectMap crimeMap{ Vector<int>{} };
+	EffectMap fireProtectionMap{ Vector<int>{} };
+	EffectMap landValueMap{ Vector<int>{} };
+	EffectMap policeProtectionMap{ Vector<int>{} };
+	EffectMap pollutionMap{ Vector<int>{} };
+	EffectMap populationDensityMap{ Vector<int>{} };
+	EffectMap rateOfGrowthMap{ Vector<int>{} };
+	EffectMap trafficDensityMap{ Vector<int>{} };
+
+	GraphHistory residentialHistory{};
+	GraphHistory commercialHistory{};
+	GraphHistory industrialHistory{};
+	GraphHistory moneyHistory{};
+	GraphHistory crimeHistory{};
+	GraphHistory pollutionHistory{};
+
+	std::vector<SimSprite> sprites;
+
+	std::string message;
+	std::vector<std::string> budgetAdvice;
+
+	int residentialValve{ 0 };
+	int commercialValve{ 0 };
+	int industrialValve{ 0 };
+
+	int funds{ 0 };
+	int month{ 0 };
+	int year{ 0 };
+
+	int cityLoads{ 0 }; // changes whenever the whole city is replaced
+
+	bool budgetNeedsAttention{ false };
+	bool autoBulldoze{ false };
+};
+
+
+void takeSnapshot(SimulationSnapshot& snapshot, const Budget& budget);
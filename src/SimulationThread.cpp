@@ -0,0 +1,182 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#include "SimulationThread.h"
+
+
+SimulationThread::SimulationThread(Step step) :
+    mStep(std::move(step)),
+    mThread(&SimulationThread::run, this)
+{}
+
+
+SimulationThread::~SimulationThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mExit = true;
+    }
+
+    mStateChanged.notify_all();
+    mThread.join();
+}
+
+
+/**
+ * Queues \c command to run on the simulation thread before its next
+ * step. Never blocks unless the queue is full. While the simulation
+ * is held the caller owns its state, so the command runs right away.
+ *
+ * UI thread only.
+ */
+void SimulationThread::post(Command command)
+{
+    if (held())
+    {
+        command();
+        return;
+    }
+
+    while (!mCommands.push(command))
+    {
+        std::this_thread::yield();
+    }
+}
+
+
+/**
+ * Asks for a step. Safe to call from any thread, e.g. a timer.
+ */
+void SimulationThread::wake()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mWake = true;
+    }
+
+    mStateChanged.notify_all();
+}
+
+
+/**
+ * Waits for the current step to finish and keeps the simulation
+ * from starting another one until \c release() is called. Commands
+ * posted before the hold are applied first. Holds nest.
+ *
+ * UI thread only.
+ */
+void SimulationThread::hold()
+{
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        ++mHoldCount;
+        mStateChanged.wait(lock, [this] { return !mStepping; });
+    }
+
+    runCommands();
+}
+
+
+void SimulationThread::release()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        --mHoldCount;
+        mWake = true;
+    }
+
+    mStateChanged.notify_all();
+}
+
+
+/**
+ * Whether another step or a hold is waiting for the step in progress
+ * to finish. Lets work that can be put off, e.g. budget advice, give
+ * way to the live city.
+ *
+ * Simulation thread only.
+ */
+bool SimulationThread::stepWaiting()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mWake || mExit || (mHoldCount > 0);
+}
+
+
+void SimulationThread::run()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    while (true)
+    {
+        mStateChanged.wait(lock, [this] { return mExit || (mWake && mHoldCount == 0); });
+
+        if (mExit)
+        {
+            return;
+        }
+
+        mWake = false;
+        mStepping = true;
+        lock.unlock();
+
+        std::exception_ptr exception;
+
+        try
+        {
+            runCommands();
+            mStep();
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+
+        lock.lock();
+        mStepping = false;
+        mStateChanged.notify_all();
+
+        if (exception)
+        {
+            mException = exception;
+            return;
+        }
+    }
+}
+
+
+/**
+ * Rethrows, on the calling thread, an exception that stopped the
+ * simulation thread.
+ */
+void SimulationThread::rethrowException()
+{
+    std::exception_ptr exception;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        exception = mException;
+    }
+
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
+
+
+void SimulationThread::runCommands()
+{
+    Command command;
+    while (mCommands.pop(command))
+    {
+        command();
+    }
+}
@@ -0,0 +1,74 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#pragma once
+
+#include "SpscQueue.h"
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+/**
+ * Runs the simulation on its own thread.
+ *
+ * Every call to \c wake() runs one step on the simulation thread.
+ * Commands posted from the UI thread are applied right before the
+ * next step so they never land in the middle of one. The UI thread
+ * can \c hold() the simulation to get exclusive access to its state,
+ * e.g. while the budget window is open or a city is being saved.
+ */
+class SimulationThread
+{
+public:
+	using Command = std::function<void()>;
+	using Step = std::function<void()>;
+
+	SimulationThread() = delete;
+	SimulationThread(const SimulationThread&) = delete;
+	const SimulationThread& operator=(const SimulationThread&) = delete;
+
+	explicit SimulationThread(Step step);
+	~SimulationThread();
+
+	void post(Command command);
+	void wake();
+
+	void hold();
+	void release();
+
+	bool held() const { return mHoldCount > 0; }
+	bool stepWaiting();
+
+	void rethrowException();
+
+private:
+	void run();
+	void runCommands();
+
+	Step mStep;
+	SpscQueue<Command, 256> mCommands;
+
+	std::mutex mMutex;
+	std::condition_variable mStateChanged;
+
+	std::exception_ptr mException;
+
+	int mHoldCount{ 0 };
+
+	bool mWake{ false };
+	bool mStepping{ false };
+	bool mExit{ false };
+
+	std::thread mThread;
+};
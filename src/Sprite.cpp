@@ -49,21 +49,48 @@ namespace
         { SimSprite::Type::Explosion, "7" }
     };
 
+    const std::map<SimSprite::Type, int> SpriteFrameCount
+    {
+        { SimSprite::Type::Train, 5 },
+        { SimSprite::Type::Helicopter, 9 },
+        { SimSprite::Type::Airplane, 12 },
+        { SimSprite::Type::Ship, 9 },
+        { SimSprite::Type::Monster, 17 },
+        { SimSprite::Type::Tornado, 3 },
+        { SimSprite::Type::Explosion, 6 }
+    };
+
+    std::map<SimSprite::Type, std::vector<Texture>> SpriteFrames;
+
     Point<int> CrashPosition{};
 
 
-    void loadSpriteImages(SimSprite::Type type, int frames, std::vector<Texture>& frameList)
+    std::vector<Texture>& spriteFrames(SimSprite::Type type)
     {
-        if(!frameList.empty())
+        auto& frameList = SpriteFrames[type];
+        if (!frameList.empty())
         {
-            return;
+            return frameList;
         }
 
-        for (int i = 0; i < frames; i++)
+        for (int i = 0; i < SpriteFrameCount.at(type); i++)
         {
             std::string name = std::string("images/obj") + SpriteTypeToId.at(type) + "-" + std::to_string(i) + ".xpm";
             frameList.push_back(loadTexture(MainWindowRenderer, name));
         }
+
+        return frameList;
+    }
+
+
+    void loadSpriteImages(SimSprite::Type type, std::vector<Texture>& frameList)
+    {
+        if(!frameList.empty())
+        {
+            return;
+        }
+
+        frameList = spriteFrames(type);
     }
 
 
@@ -94,7 +121,7 @@ namespace
             sprite.hot = { 40, -8 };
             sprite.frame = 1;
             sprite.dir = 4;
-            loadSpriteImages(SimSprite::Type::Train, 5, sprite.frames);
+            loadSpriteImages(SimSprite::Type::Train, sprite.frames);
             break;
 
         case SimSprite::Type::Ship:
@@ -126,7 +153,7 @@ namespace
             sprite.new_dir = sprite.frame;
             sprite.dir = 0;
             sprite.count = 1;
-            loadSpriteImages(SimSprite::Type::Ship, 9, sprite.frames);
+            loadSpriteImages(SimSprite::Type::Ship, sprite.frames);
             break;
 
         case SimSprite::Type::Monster:
@@ -150,7 +177,7 @@ namespace
                 sprite.frame = 4;
             }
             sprite.count = 1000;
-            loadSpriteImages(SimSprite::Type::Monster, 17, sprite.frames);
+            loadSpriteImages(SimSprite::Type::Monster, sprite.frames);
             break;
 
         case SimSprite::Type::Helicopter:
@@ -161,7 +188,7 @@ namespace
             sprite.origin = position + Vector<int>{ -30, 0 };
             sprite.frame = 5;
             sprite.count = 1500;
-            loadSpriteImages(SimSprite::Type::Helicopter, 9, sprite.frames);
+            loadSpriteImages(SimSprite::Type::Helicopter, sprite.frames);
             break;
 
         case SimSprite::Type::Airplane:
@@ -175,7 +202,7 @@ namespace
                 RandomRange(0, (SimHeight * 16) + 100) - 50
             };
 
-            loadSpriteImages(SimSprite::Type::Airplane, 12, sprite.frames);
+            loadSpriteImages(SimSprite::Type::Airplane, sprite.frames);
             break;
 
         case SimSprite::Type::Tornado:
@@ -184,7 +211,7 @@ namespace
             sprite.hot = { 40, 36 };
             sprite.frame = 0;
             sprite.count = 200;
-            loadSpriteImages(SimSprite::Type::Tornado, 3, sprite.frames);
+            loadSpriteImages(SimSprite::Type::Tornado, sprite.frames);
             break;
 
         case SimSprite::Type::Explosion:
@@ -192,7 +219,7 @@ namespace
             sprite.offset = { 24, 0 };
             sprite.hot = { 40, 16 };
             sprite.frame = 0;
-            loadSpriteImages(SimSprite::Type::Explosion, 6, sprite.frames);
+            loadSpriteImages(SimSprite::Type::Explosion, sprite.frames);
             break;
 
         default:
@@ -221,7 +248,7 @@ namespace
     }
 
 
-    void drawSprite(SimSprite& sprite)
+    void drawSprite(const SimSprite& sprite)
     {
         const auto& spriteFrame = sprite.frames[sprite.frame];
 
@@ -265,9 +292,40 @@ SimSprite* getSprite(SimSprite::Type type)
 }
 
 
+/**
+ * Loads the frames of every sprite type up front so sprites can be
+ * created away from the thread that owns the renderer.
+ */
+void loadSpriteTextures()
+{
+    for (const auto& [type, count] : SpriteFrameCount)
+    {
+        spriteFrames(type);
+    }
+}
+
+
+const std::vector<SimSprite>& sprites()
+{
+    return Sprites;
+}
+
+
+void sprites(const std::vector<SimSprite>& spriteList)
+{
+    Sprites = spriteList;
+}
+
+
 void drawSprites()
 {
-    for (auto& sprite : Sprites)
+    drawSprites(Sprites);
+}
+
+
+void drawSprites(const std::vector<SimSprite>& spriteList)
+{
+    for (auto& sprite : spriteList)
     {
         if (!sprite.active)
         {
@@ -463,6 +521,8 @@ void oFireZone(int Xloc, int Yloc, int ch)
 {
     int XYmax;
 
+    Zones.remove({ Xloc, Yloc });
+
     const auto rogVal = RateOfGrowthMap.value({ Xloc >> 3, Yloc >> 3 });
     RateOfGrowthMap.value({ Xloc >> 3, Yloc >> 3 }) = rogVal - 20;
 
@@ -17,6 +17,8 @@
 #include <string>
 #include <vector>
 
+extern int Cycle;
+
 struct SimSprite
 {
 	enum class Type
@@ -63,7 +65,12 @@ Point<int>& crashPosition();
 void crashPosition(const Point<int>& position);
 
 SimSprite* getSprite(SimSprite::Type type);
+const std::vector<SimSprite>& sprites();
+void sprites(const std::vector<SimSprite>& spriteList);
+
+void loadSpriteTextures();
 void drawSprites();
+void drawSprites(const std::vector<SimSprite>& spriteList);
 void destroyAllSprites();
 void updateSprites();
 
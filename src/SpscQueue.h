@@ -0,0 +1,71 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+
+/**
+ * Fixed size, lock free queue for one producer thread and one
+ * consumer thread.
+ */
+template <typename T, std::size_t Capacity>
+class SpscQueue
+{
+public:
+	/**
+	 * Returns false without queueing \c value if the queue is full.
+	 */
+	bool push(T value)
+	{
+		const std::size_t tail = mTail.load(std::memory_order_relaxed);
+		const std::size_t next = (tail + 1) % SlotCount;
+
+		if (next == mHead.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+
+		mSlots[tail] = std::move(value);
+		mTail.store(next, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Returns false and leaves \c value untouched if the queue is empty.
+	 */
+	bool pop(T& value)
+	{
+		const std::size_t head = mHead.load(std::memory_order_relaxed);
+
+		if (head == mTail.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+
+		value = std::move(mSlots[head]);
+		mSlots[head] = T{};
+		mHead.store((head + 1) % SlotCount, std::memory_order_release);
+		return true;
+	}
+
+private:
+	// One slot is always left empty to tell a full queue from an empty one.
+	static constexpr std::size_t SlotCount{ Capacity + 1 };
+
+	std::array<T, SlotCount> mSlots{};
+
+	std::atomic<std::size_t> mHead{ 0 };
+	std::atomic<std::size_t> mTail{ 0 };
+};
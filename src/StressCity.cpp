@@ -0,0 +1,119 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#include "StressCity.h"
+
+#include "Budget.h"
+#include "CityProperties.h"
+#include "Map.h"
+#include "ToolBatch.h"
+
+#include "s_fileio.h"
+
+#include <array>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+namespace
+{
+    constexpr int PlantColumns{ 4 }; // coal plants down the west edge
+    constexpr int BlockSize{ 9 }; // three zones across
+    constexpr int StreetSpacing{ BlockSize + 1 }; // a street west of every block
+    constexpr int AvenueSpacing{ BlockSize + 2 }; // a street north and a power line south of every block
+
+    constexpr int StartingFunds{ 1000000 };
+
+
+    /**
+     * What a block is filled with and how often, out of 20.
+     */
+    const std::array<std::pair<Tool, int>, 5> BlockMix
+    {{
+        { Tool::Residential, 9 },
+        { Tool::Commercial, 4 },
+        { Tool::Industrial, 5 },
+        { Tool::Police, 1 },
+        { Tool::Fire, 1 }
+    }};
+
+
+    Tool blockTool(std::mt19937& random)
+    {
+        int pick = std::uniform_int_distribution<int>(0, 19)(random);
+        for (const auto& [tool, weight] : BlockMix)
+        {
+            if (pick < weight)
+            {
+                return tool;
+            }
+
+            pick -= weight;
+        }
+
+        return Tool::Residential;
+    }
+};
+
+
+/**
+ * Builds a synthetic city for benchmarking the simulation and saves it
+ * to \c filename.
+ *
+ * The city is a grid of blocks, each filled with one kind of zone
+ * drawn from \c seed, so every seed gives a different city of the same
+ * size. Streets run around every block and a power line runs south of
+ * every row of blocks to the coal plants stamped down the west edge.
+ * Everything is put down as one tool batch.
+ */
+void generateStressCity(const std::string& filename, std::uint32_t seed, CityProperties& properties, Budget& budget)
+{
+    std::mt19937 random(seed);
+
+    properties.CityName("Stress " + std::to_string(seed));
+    budget.CurrentFunds(StartingFunds);
+
+    int zones{ 0 };
+
+    {
+        ToolBatch batch{ budget };
+
+        batch.stamp(Tool::Coal, { toolProperties(Tool::Coal).offset, toolProperties(Tool::Coal).offset },
+            { 0, toolProperties(Tool::Coal).size }, { 1, SimHeight / toolProperties(Tool::Coal).size });
+
+        for (int x = PlantColumns; x < SimWidth; x += StreetSpacing)
+        {
+            batch.polyline(Tool::Road, { { x, 0 }, { x, SimHeight - 1 } });
+        }
+
+        for (int y = 0; y < SimHeight; y += AvenueSpacing)
+        {
+            batch.polyline(Tool::Road, { { PlantColumns, y }, { SimWidth - 1, y } });
+
+            if (y + AvenueSpacing - 1 < SimHeight)
+            {
+                batch.polyline(Tool::Wire, { { PlantColumns, y + AvenueSpacing - 1 }, { SimWidth - 1, y + AvenueSpacing - 1 } });
+            }
+        }
+
+        for (int y = 1; y + BlockSize <= SimHeight; y += AvenueSpacing)
+        {
+            for (int x = PlantColumns + 1; x + BlockSize <= SimWidth; x += StreetSpacing)
+            {
+                zones += batch.rectangle(blockTool(random), { x, y }, { x + BlockSize - 1, y + BlockSize - 1 });
+            }
+        }
+    }
+
+    SaveCity(filename, properties, budget);
+
+    std::cout << "Generated '" << filename << "' with " << zones << " zones from seed " << seed << std::endl;
+}
@@ -0,0 +1,20 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+class Budget;
+class CityProperties;
+
+
+void generateStressCity(const std::string& filename, std::uint32_t seed, CityProperties&, Budget&);
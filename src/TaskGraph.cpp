@@ -0,0 +1,91 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#include "TaskGraph.h"
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+
+namespace
+{
+    bool overlaps(const std::vector<TaskGraph::Resource>& a, const std::vector<TaskGraph::Resource>& b)
+    {
+        return std::find_first_of(a.begin(), a.end(), b.begin(), b.end()) != a.end();
+    }
+};
+
+
+void TaskGraph::addTask(std::initializer_list<Resource> reads, std::initializer_list<Resource> writes, std::function<void()> task)
+{
+    Node node{ std::move(task), reads, writes, {} };
+
+    const std::size_t index = mTasks.size();
+    for (std::size_t i = 0; i < index; ++i)
+    {
+        if (dependsOn(node, mTasks[i]))
+        {
+            mTasks[i].dependents.push_back(index);
+            ++node.dependencyCount;
+        }
+    }
+
+    mTasks.push_back(std::move(node));
+}
+
+
+bool TaskGraph::dependsOn(const Node& later, const Node& earlier) const
+{
+    return overlaps(earlier.writes, later.reads) ||
+        overlaps(earlier.writes, later.writes) ||
+        overlaps(earlier.reads, later.writes);
+}
+
+
+/**
+ * Runs every task on \c pool and returns once all are done.
+ */
+void TaskGraph::run(ThreadPool& pool)
+{
+    mUnfinishedDependencies = std::make_unique<std::atomic<std::size_t>[]>(mTasks.size());
+
+    for (std::size_t i = 0; i < mTasks.size(); ++i)
+    {
+        mUnfinishedDependencies[i] = mTasks[i].dependencyCount;
+    }
+
+    for (std::size_t i = 0; i < mTasks.size(); ++i)
+    {
+        if (mTasks[i].dependencyCount == 0)
+        {
+            launch(pool, i);
+        }
+    }
+
+    pool.wait();
+}
+
+
+void TaskGraph::launch(ThreadPool& pool, std::size_t index)
+{
+    pool.push([this, &pool, index]()
+    {
+        mTasks[index].task();
+
+        for (const auto dependent : mTasks[index].dependents)
+        {
+            if (--mUnfinishedDependencies[dependent] == 0)
+            {
+                launch(pool, dependent);
+            }
+        }
+    });
+}
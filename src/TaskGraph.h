@@ -0,0 +1,57 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+class ThreadPool;
+
+
+/**
+ * Set of tasks with declared inputs and outputs.
+ *
+ * Tasks are added in serial order. A task waits for every earlier
+ * task that writes something it reads or writes, or that reads
+ * something it writes, so running the graph on a thread pool gives
+ * the same results as running the tasks one after another.
+ */
+class TaskGraph
+{
+public:
+	using Resource = unsigned int;
+
+	void addTask(std::initializer_list<Resource> reads, std::initializer_list<Resource> writes, std::function<void()> task);
+
+	std::size_t size() const { return mTasks.size(); }
+
+	void run(ThreadPool& pool);
+
+private:
+	struct Node
+	{
+		std::function<void()> task;
+		std::vector<Resource> reads;
+		std::vector<Resource> writes;
+		std::vector<std::size_t> dependents;
+		std::size_t dependencyCount{};
+	};
+
+	bool dependsOn(const Node& later, const Node& earlier) const;
+	void launch(ThreadPool& pool, std::size_t index);
+
+	std::vector<Node> mTasks;
+	std::unique_ptr<std::atomic<std::size_t>[]> mUnfinishedDependencies;
+};
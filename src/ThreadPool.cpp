@@ -0,0 +1,188 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#include "ThreadPool.h"
+
+
+namespace
+{
+    // Pool and queue owned by the calling thread, if it's a worker.
+    thread_local const ThreadPool* WorkerPool{ nullptr };
+    thread_local std::size_t WorkerIndex{ 0 };
+};
+
+
+ThreadPool::ThreadPool(std::size_t threadCount)
+{
+    // Queue 0 belongs to whichever thread calls wait() so it counts as one worker.
+    const std::size_t queueCount = threadCount > 0 ? threadCount : 1;
+
+    for (std::size_t i = 0; i < queueCount; ++i)
+    {
+        mQueues.push_back(std::make_unique<TaskQueue>());
+    }
+
+    for (std::size_t i = 1; i < queueCount; ++i)
+    {
+        mWorkers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mExit = true;
+    }
+
+    mStateChanged.notify_all();
+
+    for (auto& worker : mWorkers)
+    {
+        worker.join();
+    }
+}
+
+
+/**
+ * Queues a task on the calling thread's queue. Tasks may push
+ * further tasks, \c wait() returns once all of them are done.
+ */
+void ThreadPool::push(Task task)
+{
+    const std::size_t index = (WorkerPool == this) ? WorkerIndex : 0;
+
+    ++mPending;
+
+    {
+        std::lock_guard<std::mutex> lock(mQueues[index]->mutex);
+        mQueues[index]->tasks.push_back(std::move(task));
+    }
+
+    ++mQueued;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+    }
+
+    mStateChanged.notify_all();
+}
+
+
+/**
+ * Runs queued tasks on the calling thread until every pushed
+ * task has finished. Must not be called from a task.
+ */
+void ThreadPool::wait()
+{
+    while (mPending > 0)
+    {
+        Task task;
+        if (popTask(0, task))
+        {
+            runTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mStateChanged.wait(lock, [this] { return mPending == 0 || mQueued > 0; });
+    }
+}
+
+
+/**
+ * Runs \c job once for every index in [0, count) and waits for
+ * all of them to finish.
+ */
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& job)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        push([&job, i]() { job(i); });
+    }
+
+    wait();
+}
+
+
+/**
+ * Takes the newest task from queue \c index or, failing that,
+ * steals the oldest task from one of the other queues.
+ */
+bool ThreadPool::popTask(std::size_t index, Task& task)
+{
+    {
+        auto& queue = *mQueues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            --mQueued;
+            return true;
+        }
+    }
+
+    for (std::size_t i = 1; i < mQueues.size(); ++i)
+    {
+        auto& queue = *mQueues[(index + i) % mQueues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            --mQueued;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void ThreadPool::runTask(Task& task)
+{
+    task();
+
+    if (--mPending == 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+        }
+
+        mStateChanged.notify_all();
+    }
+}
+
+
+void ThreadPool::workerLoop(std::size_t index)
+{
+    WorkerPool = this;
+    WorkerIndex = index;
+
+    while (true)
+    {
+        Task task;
+        if (popTask(index, task))
+        {
+            runTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mStateChanged.wait(lock, [this] { return mExit || mQueued > 0; });
+
+        if (mExit)
+        {
+            return;
+        }
+    }
+}
@@ -0,0 +1,71 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/**
+ * Fixed size pool of worker threads with work stealing.
+ *
+ * Every thread, including the one calling \c wait(), owns a task
+ * queue. Tasks pushed from a worker go to its own queue and idle
+ * threads steal from the other end of everyone else's.
+ */
+class ThreadPool
+{
+public:
+	using Task = std::function<void()>;
+
+	ThreadPool() = delete;
+	ThreadPool(const ThreadPool&) = delete;
+	const ThreadPool& operator=(const ThreadPool&) = delete;
+
+	explicit ThreadPool(std::size_t threadCount);
+	~ThreadPool();
+
+	std::size_t threadCount() const { return mQueues.size(); }
+
+	void push(Task task);
+	void wait();
+
+	void parallelFor(std::size_t count, const std::function<void(std::size_t)>& job);
+
+private:
+	struct TaskQueue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	void workerLoop(std::size_t index);
+	bool popTask(std::size_t index, Task& task);
+	void runTask(Task& task);
+
+	std::vector<std::unique_ptr<TaskQueue>> mQueues;
+	std::vector<std::thread> mWorkers;
+
+	std::mutex mMutex;
+	std::condition_variable mStateChanged;
+
+	std::atomic<std::size_t> mQueued{};
+	std::atomic<std::size_t> mPending{};
+
+	bool mExit{ false };
+};
@@ -0,0 +1,226 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#pragma once
+
+#include "Map.h"
+
+#include <array>
+#include <cstdint>
+
+
+/**
+ * What a tile is, as far as the simulation is concerned.
+ */
+enum class TileClass : std::uint8_t
+{
+	Clear,
+	Water,
+	Trees,
+	Rubble,
+	Flood,
+	Radiation,
+	Fire,
+	Road,
+	Power,
+	Rail,
+	Residential,
+	Hospital, // hospitals and churches
+	Commercial,
+	Industrial,
+	Special, // ports, airports, power plants, stations and stadiums
+	Explosion,
+	Other
+};
+
+
+/**
+ * Everything the simulation looks up about a tile value, packed so the
+ * whole table stays in L1.
+ */
+struct TileProperties
+{
+	enum Flags : std::uint8_t
+	{
+		RiverEdge = 1 << 0,
+		Drivable = 1 << 1, // traffic can pass through it
+		CountsHouses = 1 << 2 // population comes from the houses around it
+	};
+
+	TileClass tileClass{ TileClass::Other };
+	std::uint8_t pollution{};
+	std::uint8_t traffic{}; // 0 none, 1 light, 2 heavy
+	std::uint8_t population{}; // zone centres only
+	std::uint8_t flags{};
+
+	constexpr bool has(Flags flag) const { return (flags & flag) != 0; }
+};
+
+
+namespace TileTable
+{
+	constexpr TileClass tileClass(int tile)
+	{
+		if (tile < RIVER) { return TileClass::Clear; }
+		if (tile <= LASTRIVEDGE) { return TileClass::Water; }
+		if (tile < RUBBLE) { return TileClass::Trees; }
+		if (tile < FLOOD) { return TileClass::Rubble; }
+		if (tile < RADTILE) { return TileClass::Flood; }
+		if (tile < FIREBASE) { return TileClass::Radiation; }
+		if (tile < ROADBASE) { return TileClass::Fire; }
+		if (tile < POWERBASE) { return TileClass::Road; }
+		if (tile <= LASTPOWER) { return TileClass::Power; }
+		if (tile < RAILBASE) { return TileClass::Other; }
+		if (tile < ResidentialBase) { return TileClass::Rail; }
+		if (tile < HOSPITAL) { return TileClass::Residential; }
+		if (tile < COMBASE) { return TileClass::Hospital; }
+		if (tile < INDBASE) { return TileClass::Commercial; }
+		if (tile < PORTBASE) { return TileClass::Industrial; }
+		if (tile <= LASTZONE) { return TileClass::Special; }
+		if ((tile >= SOMETINYEXP) && (tile <= LASTTINYEXP)) { return TileClass::Explosion; }
+		return TileClass::Other;
+	}
+
+
+	constexpr int pollution(int tile)
+	{
+		if (tile < POWERBASE)
+		{
+			if (tile >= HTRFBASE) /* heavy traf  */
+			{
+				return (/* 25 */ 75);
+			}
+
+			if (tile >= LTRFBASE) /* light traf  */
+			{
+				return (/* 10 */ 50);
+			}
+
+			if (tile < ROADBASE)
+			{
+				if (tile > FIREBASE)
+				{
+					return (/* 60 */ 90);
+				}
+
+				/* XXX: Why negative pollution from radiation? */
+				if (tile >= RADTILE) /* radioactivity  */
+				{
+					return (/* -40 */ 255);
+				}
+			}
+			return 0;
+		}
+
+		if (tile <= LASTIND)
+		{
+			return (0);
+		}
+
+		if (tile < PORTBASE) /* Ind  */
+		{
+			return (50);
+		}
+
+		if (tile <= LASTPOWERPLANT) /* prt, aprt, cpp */
+		{
+			return (/* 60 */ 100);
+		}
+
+		return 0;
+	}
+
+
+	constexpr int traffic(int tile)
+	{
+		if (tile < LTRFBASE)
+		{
+			return 0;
+		}
+
+		return tile < HTRFBASE ? 1 : 2;
+	}
+
+
+	constexpr int population(int tile)
+	{
+		switch (tileClass(tile))
+		{
+		case TileClass::Residential:
+		case TileClass::Hospital:
+			return ((((tile - RZB) / 9) % 4) * 8) + 16;
+
+		case TileClass::Commercial:
+			return (tile == CommercialEmpty) ? 0 : (((tile - CZB) / 9) % 5) + 1;
+
+		case TileClass::Industrial:
+			return (tile == IndustryEmpty) ? 0 : (((tile - IZB) / 9) % 4) + 1;
+
+		default:
+			return 0;
+		}
+	}
+
+
+	constexpr std::uint8_t flags(int tile)
+	{
+		std::uint8_t flags{};
+
+		if ((tile >= FIRSTRIVEDGE) && (tile <= LASTRIVEDGE))
+		{
+			flags |= TileProperties::RiverEdge;
+		}
+
+		if ((tile >= ROADBASE) && (tile <= LASTRAIL) && !((tile >= POWERBASE) && (tile < RAILHPOWERV)))
+		{
+			flags |= TileProperties::Drivable;
+		}
+
+		if (tile == ResidentialEmpty)
+		{
+			flags |= TileProperties::CountsHouses;
+		}
+
+		return flags;
+	}
+
+
+	constexpr std::array<TileProperties, LOMASK + 1> build()
+	{
+		std::array<TileProperties, LOMASK + 1> table{};
+
+		for (int tile = 0; tile < TILE_COUNT; ++tile)
+		{
+			auto& entry = table[tile];
+			entry.tileClass = tileClass(tile);
+			entry.pollution = static_cast<std::uint8_t>(pollution(tile));
+			entry.traffic = static_cast<std::uint8_t>(entry.tileClass == TileClass::Road ? traffic(tile) : 0);
+			entry.population = static_cast<std::uint8_t>(population(tile));
+			entry.flags = flags(tile);
+		}
+
+		return table;
+	}
+
+
+	/**
+	 * One entry for every possible 10 bit tile value, built at compile time.
+	 */
+	inline constexpr auto Properties = build();
+};
+
+
+/**
+ * Properties of \c tile. Status bits are masked off.
+ */
+constexpr const TileProperties& tileProperties(unsigned int tile)
+{
+	return TileTable::Properties[tile & LOMASK];
+}
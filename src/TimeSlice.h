@@ -0,0 +1,40 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#pragma once
+
+#include <chrono>
+
+
+/**
+ * Deadline for a piece of work that may be split over several frames.
+ * A default constructed slice never expires.
+ */
+class TimeSlice
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	TimeSlice() = default;
+
+	explicit TimeSlice(Clock::duration length) :
+		mDeadline{ Clock::now() + length },
+		mLimited{ true }
+	{}
+
+	bool expired() const
+	{
+		return mLimited && Clock::now() >= mDeadline;
+	}
+
+private:
+	Clock::time_point mDeadline{};
+	bool mLimited{ false };
+};
@@ -0,0 +1,84 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#include "TimingWheel.h"
+
+
+/**
+ * Schedules \c location for tick \c due, which should be after now().
+ */
+void TimingWheel::schedule(const Point<int>& location, Time due)
+{
+    const Time delay = due - mNow;
+
+    if (delay < SlotCount)
+    {
+        mNear[due & SlotMask].push_back({ location, due });
+    }
+    else if (delay < SlotCount * SlotCount)
+    {
+        mFar[(due >> SlotBits) & SlotMask].push_back({ location, due });
+    }
+    else
+    {
+        mFar[((mNow >> SlotBits) + SlotMask) & SlotMask].push_back({ location, due });
+    }
+
+    ++mSize;
+}
+
+
+/**
+ * Moves on to the next tick and replaces the contents of \c due with
+ * everything scheduled for it, in the order it was scheduled.
+ */
+void TimingWheel::advance(std::vector<Point<int>>& due)
+{
+    ++mNow;
+    due.clear();
+
+    if ((mNow & SlotMask) == 0)
+    {
+        auto cascade = std::move(mFar[(mNow >> SlotBits) & SlotMask]);
+        mFar[(mNow >> SlotBits) & SlotMask].clear();
+
+        mSize -= cascade.size();
+        for (const auto& entry : cascade)
+        {
+            schedule(entry.location, entry.due);
+        }
+    }
+
+    auto& slot = mNear[mNow & SlotMask];
+    for (const auto& entry : slot)
+    {
+        due.push_back(entry.location);
+    }
+
+    mSize -= slot.size();
+    slot.clear();
+}
+
+
+void TimingWheel::clear()
+{
+    for (auto& slot : mNear)
+    {
+        slot.clear();
+    }
+
+    for (auto& slot : mFar)
+    {
+        slot.clear();
+    }
+
+    mNow = 0;
+    mSize = 0;
+}
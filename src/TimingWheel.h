@@ -0,0 +1,60 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#pragma once
+
+#include "Point.h"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+
+/**
+ * Two level timing wheel of map locations.
+ *
+ * The near wheel has a slot per tick for the next 256 ticks, the far
+ * wheel a slot per 256 ticks. Far slots are moved down into the near
+ * wheel as time reaches them, so scheduling and advancing cost the
+ * same no matter how far ahead something is due. Anything due further
+ * out than the far wheel reaches waits in its last slot and is put
+ * back in when that slot comes around.
+ */
+class TimingWheel
+{
+public:
+	using Time = unsigned int;
+
+	void schedule(const Point<int>& location, Time due);
+	void advance(std::vector<Point<int>>& due);
+	void clear();
+
+	Time now() const { return mNow; }
+	std::size_t size() const { return mSize; }
+
+private:
+	static constexpr Time SlotBits{ 8 };
+	static constexpr Time SlotCount{ 1 << SlotBits };
+	static constexpr Time SlotMask{ SlotCount - 1 };
+
+	struct Entry
+	{
+		Point<int> location;
+		Time due{};
+	};
+
+	using Wheel = std::array<std::vector<Entry>, SlotCount>;
+
+	Wheel mNear;
+	Wheel mFar;
+
+	Time mNow{ 0 };
+	std::size_t mSize{ 0 };
+};
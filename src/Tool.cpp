@@ -12,7 +12,9 @@
 
 #include "Budget.h"
 #include "Connection.h"
+#include "SimulationSnapshot.h"
 #include "Tool.h"
+#include "ToolBatch.h"
 
 #include "s_alloc.h"
 #include "s_msg.h"
@@ -30,6 +32,7 @@
 #include <map>
 #include <string>
 #include <stdexcept>
+#include <vector>
 
 int specialBase = CHURCH;
 
@@ -125,11 +128,11 @@ const Point<int>& toolEnd()
 }
 
 
-ToolResult putDownPark(int mapH, int mapV, Budget& budget)
+ToolResult putDownPark(int mapH, int mapV, ToolBatch& batch)
 {
     int tile{};
 
-    if (budget.CanAfford(Tools.at(Tool::Park).cost))
+    if (batch.charge().funds() >= Tools.at(Tool::Park).cost)
     {
         int value = RandomRange(0, 4);
 
@@ -144,8 +147,7 @@ ToolResult putDownPark(int mapH, int mapV, Budget& budget)
 
         if (Map[mapH][mapV] == 0)
         {
-            budget.Spend(Tools.at(Tool::Park).cost);
-            UpdateFunds(budget);
+            batch.charge().spend(Tools.at(Tool::Park).cost);
             Map[mapH][mapV] = tile;
             return ToolResult::Success;
         }
@@ -158,14 +160,14 @@ ToolResult putDownPark(int mapH, int mapV, Budget& budget)
 
 
 // Radar?
-ToolResult putDownNetwork(int mapH, int mapV, Budget& budget)
+ToolResult putDownNetwork(int mapH, int mapV, ToolBatch& batch)
 {
     int tile = Map[mapH][mapV] & LOMASK;
 
-    if ((budget.CurrentFunds() > 0) && tally(tile))
+    if ((batch.charge().funds() > 0) && tally(tile))
     {
         Map[mapH][mapV] = tile = 0;
-        budget.Spend(1);
+        batch.charge().spend(1);
     }
 
     if (tile != 0)
@@ -173,10 +175,10 @@ ToolResult putDownNetwork(int mapH, int mapV, Budget& budget)
         return ToolResult::RequiresBulldozing;
     }
 
-    if (budget.CanAfford(Tools.at(Tool::Network).cost))
+    if (batch.charge().funds() >= Tools.at(Tool::Network).cost)
     {
         Map[mapH][mapV] = TELEBASE | CONDBIT | BURNBIT | BULLBIT | ANIMBIT;
-        budget.Spend(Tools.at(Tool::Network).cost);
+        batch.charge().spend(Tools.at(Tool::Network).cost);
         return ToolResult::Success;
     }
     else
@@ -346,16 +348,16 @@ int checkSize(int temp)
 }
 
 
-void doConnectTile(const int x, const int y, const int w, const int h, Budget& budget)
+void doConnectTile(const int x, const int y, ToolCharge& charge, ConnectionFixup& fixup)
 {
     if (CoordinatesValid({ x, y }))
     {
-        ConnectTile(x, y, Tool::None, budget);
+        ConnectTile(x, y, Tool::None, charge, fixup);
     }
 }
 
 
-void checkBorder(const int mapX, const int mapY, const int count, Budget& budget)
+void checkBorder(const int mapX, const int mapY, const int count, ToolBatch& batch)
 {
     int xPos{}, yPos{};
 
@@ -363,7 +365,7 @@ void checkBorder(const int mapX, const int mapY, const int count, Budget& budget
     for (int cnt = 0; cnt < count; cnt++)
     {
         /*** this will do the upper bordering row ***/
-        doConnectTile(xPos, yPos, SimWidth, SimHeight, budget);
+        doConnectTile(xPos, yPos, batch.charge(), batch.fixup());
         xPos++;
     }
 
@@ -371,7 +373,7 @@ void checkBorder(const int mapX, const int mapY, const int count, Budget& budget
     for (int cnt = 0; cnt < count; cnt++)
     {
         /*** this will do the left bordering row ***/
-        doConnectTile(xPos, yPos, SimWidth, SimHeight, budget);
+        doConnectTile(xPos, yPos, batch.charge(), batch.fixup());
         yPos++;
     }
 
@@ -379,7 +381,7 @@ void checkBorder(const int mapX, const int mapY, const int count, Budget& budget
     for (int cnt = 0; cnt < count; cnt++)
     {
         /*** this will do the bottom bordering row ***/
-        doConnectTile(xPos, yPos, SimWidth, SimHeight, budget);
+        doConnectTile(xPos, yPos, batch.charge(), batch.fixup());
         xPos++;
     }
 
@@ -387,13 +389,13 @@ void checkBorder(const int mapX, const int mapY, const int count, Budget& budget
     for (int cnt = 0; cnt < count; cnt++)
     {
         /*** this will do the right bordering row ***/
-        doConnectTile(xPos, yPos, SimWidth, SimHeight, budget);
+        doConnectTile(xPos, yPos, batch.charge(), batch.fixup());
         yPos++;
     }
 }
 
 
-ToolResult checkArea(const int mapH, const int mapV, const int base, const int size, const bool animate, const Tool tool, Budget& budget)
+ToolResult checkArea(const int mapH, const int mapV, const int base, const int size, const bool animate, const Tool tool, ToolBatch& batch)
 {
     if (!pointInRect({ mapH - 1, mapV - 1 }, { 0, 0, SimWidth - size, SimHeight - size }))
     {
@@ -447,13 +449,12 @@ ToolResult checkArea(const int mapH, const int mapV, const int base, const int s
         return ToolResult::RequiresBulldozing;
     }
 
-    if (!budget.CanAfford(totalCost))
+    if (batch.charge().funds() < totalCost)
     {
         return ToolResult::InsufficientFunds;
     }
 
-    budget.Spend(totalCost);
-    UpdateFunds(budget);
+    batch.charge().spend(totalCost);
 
     int tileBase = base;
     mapY = mapV - 1;
@@ -466,6 +467,7 @@ ToolResult checkArea(const int mapH, const int mapV, const int base, const int s
             if (col == 1 && row == 1)
             {
                 Map[mapX][mapY] = tileBase + BNCNBIT + ZONEBIT;
+                Zones.add({ mapX, mapY }, tileBase);
             }
             // special case to get nuclear plant animation working
             else if (animate && col == 1 && row == 2)
@@ -482,7 +484,7 @@ ToolResult checkArea(const int mapH, const int mapV, const int base, const int s
         ++mapY;
     }
 
-    checkBorder(mapH - 1, mapV - 1, size, budget);
+    checkBorder(mapH - 1, mapV - 1, size, batch);
     return ToolResult::Success;
 }
 
@@ -667,6 +669,8 @@ void doZoneStatus(int x, int y)
 
 void putRubble(const int mapX, const int mapY, const int size)
 {
+    Zones.remove({ mapX, mapY });
+
     for (int x = mapX - 1; x < mapX + size - 1; x++)
     {
         for (int y = mapY - 1; y < mapY + size - 1; y++)
@@ -688,7 +692,7 @@ void putRubble(const int mapX, const int mapY, const int size)
 /* TOOLS */
 
 
-ToolResult query_tool(int x, int y, Budget&)
+ToolResult query_tool(int x, int y, ToolBatch&)
 {
     if (!CoordinatesValid({ x, y }))
     {
@@ -700,7 +704,7 @@ ToolResult query_tool(int x, int y, Budget&)
 }
 
 
-ToolResult bulldozer_tool(int x, int y, Budget& budget)
+ToolResult bulldozer_tool(int x, int y, ToolBatch& batch)
 {
     unsigned int currTile, temp;
     int zoneSize, deltaH, deltaV;
@@ -717,9 +721,9 @@ ToolResult bulldozer_tool(int x, int y, Budget& budget)
 
     if (currTile & ZONEBIT)
     { /* zone center bit is set */
-        if (!budget.Broke())
+        if (!batch.charge().broke())
         {
-            budget.Spend(1);
+            batch.charge().spend(1);
             switch (checkSize(temp))
             {
             case 3:
@@ -745,9 +749,9 @@ ToolResult bulldozer_tool(int x, int y, Budget& budget)
     }
     else if ((zoneSize = checkBigZone(temp, &deltaH, &deltaV)))
     {
-        if (!budget.Broke())
+        if (!batch.charge().broke())
         {
-            budget.Spend(1);
+            batch.charge().spend(1);
             switch (zoneSize)
             {
             case 3:
@@ -771,12 +775,12 @@ ToolResult bulldozer_tool(int x, int y, Budget& budget)
     {
         if (temp == RIVER || temp == REDGE || temp == CHANNEL)
         {
-            if (budget.CanAfford(5)) /// \fixme Magic Number
+            if (batch.charge().funds() >= 5) /// \fixme Magic Number
             {
-                result = ConnectTile(x, y, Tool::Bulldoze, budget);
+                result = ConnectTile(x, y, Tool::Bulldoze, batch.charge(), batch.fixup());
                 if (temp != (Map[x][y] & LOMASK))
                 {
-                    budget.Spend(5);
+                    batch.charge().spend(5);
                 }
             }
             else
@@ -786,186 +790,180 @@ ToolResult bulldozer_tool(int x, int y, Budget& budget)
         }
         else
         {
-            result = ConnectTile(x, y, Tool::Bulldoze, budget);
+            result = ConnectTile(x, y, Tool::Bulldoze, batch.charge(), batch.fixup());
         }
     }
-    UpdateFunds(budget);
+
     return result;
 }
 
 
-ToolResult road_tool(int x, int y, Budget& budget)
+ToolResult road_tool(int x, int y, ToolBatch& batch)
 {
     if (!CoordinatesValid({ x, y }))
     {
         return ToolResult::OutOfBounds;
     }
 
-    ToolResult result = ConnectTile(x, y, Tool::Road, budget);
-    UpdateFunds(budget);
-    return result;
+    return ConnectTile(x, y, Tool::Road, batch.charge(), batch.fixup());
 }
 
 
-ToolResult rail_tool(int x, int y, Budget& budget)
+ToolResult rail_tool(int x, int y, ToolBatch& batch)
 {
     if (!CoordinatesValid({ x, y }))
     {
         return ToolResult::OutOfBounds;
     }
 
-    ToolResult result = ConnectTile(x, y, Tool::Rail, budget);
-    UpdateFunds(budget);
-    return result;
+    return ConnectTile(x, y, Tool::Rail, batch.charge(), batch.fixup());
 }
 
 
-ToolResult wire_tool(int x, int y, Budget& budget)
+ToolResult wire_tool(int x, int y, ToolBatch& batch)
 {
     if (!CoordinatesValid({ x, y }))
     {
         return ToolResult::OutOfBounds;
     }
 
-    ToolResult result = ConnectTile(x, y, Tool::Wire, budget);
-    UpdateFunds(budget);
-    return result;
+    return ConnectTile(x, y, Tool::Wire, batch.charge(), batch.fixup());
 }
 
 
-ToolResult park_tool(int x, int y, Budget& budget)
+ToolResult park_tool(int x, int y, ToolBatch& batch)
 {
     if (!CoordinatesValid({ x, y }))
     {
         return ToolResult::OutOfBounds;
     }
 
-    return putDownPark(x, y, budget);
+    return putDownPark(x, y, batch);
 }
 
 
-ToolResult residential_tool(int x, int y, Budget& budget)
+ToolResult residential_tool(int x, int y, ToolBatch& batch)
 {
     if (!CoordinatesValid({ x, y }))
     {
         return ToolResult::OutOfBounds;
     }
 
-    return checkArea(x, y, ResidentialBase, 3, false, Tool::Residential, budget);
+    return checkArea(x, y, ResidentialBase, 3, false, Tool::Residential, batch);
 }
 
 
-ToolResult commercial_tool(int x, int y, Budget& budget)
+ToolResult commercial_tool(int x, int y, ToolBatch& batch)
 {
     if (!CoordinatesValid({ x, y }))
     {
         return ToolResult::OutOfBounds;
     }
 
-    return checkArea(x, y, COMBASE, 3, false, Tool::Commercial, budget);
+    return checkArea(x, y, COMBASE, 3, false, Tool::Commercial, batch);
 }
 
 
-ToolResult industrial_tool(int x, int y, Budget& budget)
+ToolResult industrial_tool(int x, int y, ToolBatch& batch)
 {
     if (!CoordinatesValid({ x, y }))
     {
         return ToolResult::OutOfBounds;
     }
 
-    return checkArea(x, y, INDBASE, 3, false, Tool::Industrial, budget);
+    return checkArea(x, y, INDBASE, 3, false, Tool::Industrial, batch);
 }
 
 
-ToolResult police_dept_tool(int x, int y, Budget& budget)
+ToolResult police_dept_tool(int x, int y, ToolBatch& batch)
 {
     if (!CoordinatesValid({ x, y }))
     {
         return ToolResult::OutOfBounds;
     }
 
-    return checkArea(x, y, POLICESTBASE, 3, false, Tool::Police, budget);
+    return checkArea(x, y, POLICESTBASE, 3, false, Tool::Police, batch);
 }
 
 
-ToolResult fire_dept_tool(int x, int y, Budget& budget)
+ToolResult fire_dept_tool(int x, int y, ToolBatch& batch)
 {
     if (!CoordinatesValid({ x, y }))
     {
         return ToolResult::OutOfBounds;
     }
 
-    return checkArea(x, y, FIRESTBASE, 3, false , Tool::Fire, budget);
+    return checkArea(x, y, FIRESTBASE, 3, false , Tool::Fire, batch);
 }
 
 
-ToolResult stadium_tool(int x, int y, Budget& budget)
+ToolResult stadium_tool(int x, int y, ToolBatch& batch)
 {
     if (!CoordinatesValid({ x, y }))
     {
         return ToolResult::OutOfBounds;
     }
 
-    return checkArea(x, y, STADIUMBASE, 4, false, Tool::Stadium, budget);
+    return checkArea(x, y, STADIUMBASE, 4, false, Tool::Stadium, batch);
 }
 
 
-ToolResult coal_power_plant_tool(int x, int y, Budget& budget)
+ToolResult coal_power_plant_tool(int x, int y, ToolBatch& batch)
 {
     if (!CoordinatesValid({ x, y }))
     {
         return ToolResult::OutOfBounds;
     }
 
-    return checkArea(x, y, COALBASE, 4, false, Tool::Coal, budget);
+    return checkArea(x, y, COALBASE, 4, false, Tool::Coal, batch);
 }
 
 
-ToolResult nuclear_power_plant_tool(int x, int y, Budget& budget)
+ToolResult nuclear_power_plant_tool(int x, int y, ToolBatch& batch)
 {
     if (!CoordinatesValid({ x, y }))
     {
         return ToolResult::OutOfBounds;
     }
 
-    return checkArea(x, y, NUCLEARBASE, 4, true, Tool::Nuclear, budget);
+    return checkArea(x, y, NUCLEARBASE, 4, true, Tool::Nuclear, batch);
 }
 
 
-ToolResult seaport_tool(int x, int y, Budget& budget)
+ToolResult seaport_tool(int x, int y, ToolBatch& batch)
 {
     if (!CoordinatesValid({ x, y }))
     {
         return ToolResult::OutOfBounds;
     }
 
-    return checkArea(x, y, PORTBASE, 4, false, Tool::Seaport, budget);
+    return checkArea(x, y, PORTBASE, 4, false, Tool::Seaport, batch);
 }
 
 
-ToolResult airport_tool(int x, int y, Budget& budget)
+ToolResult airport_tool(int x, int y, ToolBatch& batch)
 {
     if (!CoordinatesValid({ x, y }))
     {
         return ToolResult::OutOfBounds;
     }
 
-    return checkArea(x, y, AIRPORTBASE, 6, false, Tool::Airport, budget);
+    return checkArea(x, y, AIRPORTBASE, 6, false, Tool::Airport, batch);
 }
 
 
-ToolResult network_tool(int x, int y, Budget& budget)
+ToolResult network_tool(int x, int y, ToolBatch& batch)
 {
     if (!CoordinatesValid({ x, y }))
     {
         return ToolResult::OutOfBounds;
     }
 
-    return putDownNetwork(x, y, budget);
+    return putDownNetwork(x, y, batch);
 }
 
 
-std::map<Tool, ToolResult(*)(int, int, Budget&)> ToolFunctionTable =
+std::map<Tool, ToolResult(*)(int, int, ToolBatch&)> ToolFunctionTable =
 {
     { Tool::Residential, &residential_tool },
     { Tool::Commercial, &commercial_tool },
@@ -996,12 +994,26 @@ std::map<Tool, ToolResult(*)(int, int, Budget&)> ToolFunctionTable =
  */
 void ToolDown(const Point<int> location, Budget& budget)
 {
-    if (PendingTool == Tool::None)
+    ToolDown(PendingTool, location, budget);
+}
+
+
+ToolResult toolAction(const Tool tool, const Point<int>& location, ToolBatch& batch)
+{
+    return ToolFunctionTable.at(tool)(location.x, location.y, batch);
+}
+
+
+void ToolDown(const Tool tool, const Point<int> location, Budget& budget)
+{
+    if (tool == Tool::None)
     {
         return;
     }
 
-    ToolResult result = ToolFunctionTable.at(PendingTool)(location.x, location.y, budget);
+    ToolBatch batch{ budget };
+    const ToolResult result = batch.apply(tool, location);
+    batch.commit();
 
     if (result == ToolResult::RequiresBulldozing)
     {
@@ -1024,75 +1036,131 @@ int longestAxis(const Vector<int>& vec)
 }
 
 
-/**
- * Modifies \c toolVector
- */
-void validateDraggableToolVector(Vector<int>& toolVector, Budget& budget)
+namespace
 {
-    const int axisLarge = longestAxis(toolVector);
-    if (axisLarge == 0) { return; }
+    /**
+     * Tiles covered by a drag from \c origin along the longer axis of
+     * \c toolVector, in the order they're laid.
+     */
+    std::vector<Point<int>> draggableToolPath(const Point<int>& origin, const Vector<int>& toolVector)
+    {
+        const bool xAxisLarger = std::abs(toolVector.x) > std::abs(toolVector.y);
+        const int axis = longestAxis(toolVector);
+        const int direction = axis < 0 ? -1 : 1;
+        const Vector<int> step = xAxisLarger ? Vector<int>{ direction, 0 } : Vector<int>{ 0, direction };
+        const int length = std::abs(axis);
 
-    const int step = axisLarge < 0 ? -1 : 1;
-    const bool xAxisLarger = std::abs(toolVector.x) > std::abs(toolVector.y);
+        std::vector<Point<int>> path;
+        path.reserve(static_cast<size_t>(length) + 1);
 
-    const Point<int>& origin = toolStart();
-    
-    if (CanConnectTile(origin.x, origin.y, pendingTool(), budget) != ToolResult::Success)
-    {
-        toolVector = {};
-        return;
+        auto location = origin;
+        for (int i = 0; i <= length; ++i)
+        {
+            path.push_back(location);
+            location += step;
+        }
+
+        return path;
     }
 
-    if (xAxisLarger)
+
+    /**
+     * Shortens \c toolVector to where \c canConnect first fails.
+     */
+    template <typename CanConnect>
+    void shortenDrag(const Point<int>& origin, Vector<int>& toolVector, CanConnect canConnect)
     {
-        for (int i = 0; std::abs(i) <= std::abs(toolVector.x); i += step)
+        if (longestAxis(toolVector) == 0) { return; }
+
+        const auto path = draggableToolPath(origin, toolVector);
+        for (size_t i = 0; i < path.size(); ++i)
         {
-            const auto result = CanConnectTile(origin.x + i, origin.y, pendingTool(), budget);
-            if (result != ToolResult::Success)
+            if (canConnect(path[i]) != ToolResult::Success)
             {
-                toolVector = { i - step, 0 };
+                toolVector = (i == 0) ? Vector<int>{} : path[i - 1] - origin;
                 return;
             }
         }
     }
-    else // ew, find a better way to do this
+
+
+    /**
+     * The last drag preview checked. Mouse motion within the same tile
+     * reuses it rather than checking the whole path again.
+     */
+    struct DragPreview
     {
-        for (int i = 0; std::abs(i) <= std::abs(toolVector.y); i += step)
-        {
-            if (CanConnectTile(origin.x, origin.y + i, pendingTool(), budget) != ToolResult::Success)
-            {
-                toolVector = { 0, i - step };
-                return;
-            }
-        }
+        Tool tool{ Tool::None };
+        Point<int> origin{};
+        Vector<int> requested{};
+        Vector<int> validated{};
+    };
+
+    DragPreview LastDragPreview;
+}
+
+
+/**
+ * Shortens \c toolVector to the part of the pending drag that can be
+ * built on \c snapshot. Lets the UI preview a drag without touching
+ * the simulation. The result is reused until the tool or either end
+ * of the drag changes.
+ */
+void validateDraggableToolVector(Vector<int>& toolVector, const SimulationSnapshot& snapshot)
+{
+    if (LastDragPreview.tool == PendingTool && LastDragPreview.origin == toolStart() && LastDragPreview.requested == toolVector)
+    {
+        toolVector = LastDragPreview.validated;
+        return;
     }
+
+    const Vector<int> requested = toolVector;
+
+    shortenDrag(toolStart(), toolVector, [&](const Point<int>& location)
+    {
+        return CanConnectTile(snapshot.map, location.x, location.y, PendingTool, snapshot.funds, snapshot.autoBulldoze);
+    });
+
+    LastDragPreview = { PendingTool, toolStart(), requested, toolVector };
+}
+
+
+/**
+ * Shortens \c toolVector to the part of the drag that can be built.
+ */
+void validateDraggableToolVector(const Tool tool, const Point<int>& origin, Vector<int>& toolVector, Budget& budget)
+{
+    shortenDrag(origin, toolVector, [&](const Point<int>& location)
+    {
+        return CanConnectTile(location.x, location.y, tool, budget);
+    });
 }
 
 
 void executeDraggableTool(const Vector<int>& toolVector, const Point<int>& tilePointedAt, Budget& budget)
+{
+    executeDraggableTool(PendingTool, toolStart(), toolVector, tilePointedAt, budget);
+}
+
+
+/**
+ * Builds the whole drag as one edit: every tile is laid, then the
+ * connections are fixed up and the cost is charged once.
+ */
+void executeDraggableTool(const Tool tool, const Point<int>& origin, const Vector<int>& toolVector, const Point<int>& tilePointedAt, Budget& budget)
 {
     if (toolVector == Vector<int>{ 0, 0 })
     {
-        ToolDown(tilePointedAt, budget);
+        ToolDown(tool, tilePointedAt, budget);
         return;
     }
 
-    const bool xAxisLarger = std::abs(toolVector.x) > std::abs(toolVector.y);
-    const int axis = longestAxis(toolVector);
-    const int step = axis < 0 ? -1 : 1;
+    ToolBatch batch{ budget };
 
-    if (xAxisLarger)
+    for (const auto& location : draggableToolPath(origin, toolVector))
     {
-        for (int i = 0; std::abs(i) <= std::abs(toolVector.x); i += step)
-        {
-            ConnectTile(toolStart().x + i, toolStart().y, pendingTool(), budget);
-        }
-    }
-    else
-    {
-        for (int i = 0; std::abs(i) <= std::abs(toolVector.y); i += step)
-        {
-            ConnectTile(toolStart().x, toolStart().y + i, pendingTool(), budget);
-        }
+        ConnectTile(location.x, location.y, tool, batch.charge(), batch.fixup());
     }
+
+    batch.commit();
 }
@@ -17,6 +17,8 @@
 #include <string>
 
 class Budget;
+class ToolBatch;
+struct SimulationSnapshot;
 
 enum class Tool
 {
@@ -65,6 +67,8 @@ enum class ToolResult
 
 
 void ToolDown(const Point<int> location, Budget& budget);
+void ToolDown(const Tool tool, const Point<int> location, Budget& budget);
+ToolResult toolAction(const Tool tool, const Point<int>& location, ToolBatch& batch);
 bool tally(int tileValue);
 
 const ToolProperties& toolProperties(const Tool);
@@ -80,5 +84,7 @@ void toolEnd(const Point<int>&);
 const Point<int>& toolEnd();
 
 int longestAxis(const Vector<int>&);
-void validateDraggableToolVector(Vector<int>&, Budget&);
+void validateDraggableToolVector(Vector<int>&, const SimulationSnapshot&);
+void validateDraggableToolVector(const Tool, const Point<int>&, Vector<int>&, Budget&);
 void executeDraggableTool(const Vector<int>&, const Point<int>&, Budget&);
+void executeDraggableTool(const Tool, const Point<int>&, const Vector<int>&, const Point<int>&, Budget&);
@@ -0,0 +1,157 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#include "ToolBatch.h"
+
+#include "w_update.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+
+ToolBatch::ToolBatch(Budget& budget) :
+    mBudget{ budget },
+    mCharge{ budget }
+{}
+
+
+ToolBatch::~ToolBatch()
+{
+    commit();
+}
+
+
+/**
+ * Uses \c tool at \c location, which is in tile coords.
+ */
+ToolResult ToolBatch::apply(const Tool tool, const Point<int>& location)
+{
+    if (tool == Tool::None)
+    {
+        return ToolResult::InvalidOperation;
+    }
+
+    return toolAction(tool, location, *this);
+}
+
+
+/**
+ * Covers the tiles from \c begin to \c end, inclusive, with \c tool.
+ * Zone tools are placed edge to edge so a 3x3 zone is put down on
+ * every third tile. Returns the number of placements that succeeded.
+ */
+int ToolBatch::rectangle(const Tool tool, const Point<int>& begin, const Point<int>& end)
+{
+    const int size = std::max(toolProperties(tool).size, 1);
+    const Point<int> topLeft{ std::min(begin.x, end.x), std::min(begin.y, end.y) };
+    const Vector<int> count
+    {
+        (std::abs(end.x - begin.x) + 1) / size,
+        (std::abs(end.y - begin.y) + 1) / size
+    };
+
+    const int offset = toolProperties(tool).offset;
+    return stamp(tool, topLeft + Vector<int>{ offset, offset }, { size, size }, count);
+}
+
+
+/**
+ * Uses \c tool on every tile along the path through \c points. Each
+ * leg runs horizontally first, then vertically. Returns the number
+ * of tiles that succeeded.
+ */
+int ToolBatch::polyline(const Tool tool, const std::vector<Point<int>>& points)
+{
+    if (points.empty())
+    {
+        return 0;
+    }
+
+    int placed{};
+    auto location = points.front();
+
+    const auto place = [&]()
+    {
+        const auto result = apply(tool, location);
+        placed += (result == ToolResult::Success) ? 1 : 0;
+        return result != ToolResult::InsufficientFunds;
+    };
+
+    if (!place())
+    {
+        return placed;
+    }
+
+    for (size_t i = 1; i < points.size(); ++i)
+    {
+        const auto& target = points[i];
+        while (location != target)
+        {
+            if (location.x != target.x)
+            {
+                location.x += (target.x > location.x) ? 1 : -1;
+            }
+            else
+            {
+                location.y += (target.y > location.y) ? 1 : -1;
+            }
+
+            if (!place())
+            {
+                return placed;
+            }
+        }
+    }
+
+    return placed;
+}
+
+
+/**
+ * Uses \c tool on a grid of \c count.x by \c count.y locations
+ * starting at \c origin and \c spacing tiles apart. Returns the
+ * number of placements that succeeded.
+ */
+int ToolBatch::stamp(const Tool tool, const Point<int>& origin, const Vector<int>& spacing, const Vector<int>& count)
+{
+    int placed{};
+
+    for (int row = 0; row < count.y; ++row)
+    {
+        for (int col = 0; col < count.x; ++col)
+        {
+            const auto result = apply(tool, origin + Vector<int>{ col * spacing.x, row * spacing.y });
+            if (result == ToolResult::InsufficientFunds)
+            {
+                return placed;
+            }
+
+            placed += (result == ToolResult::Success) ? 1 : 0;
+        }
+    }
+
+    return placed;
+}
+
+
+/**
+ * Joins up everything the batch laid and takes its cost from the
+ * budget in one go.
+ */
+void ToolBatch::commit()
+{
+    mFixup.apply();
+
+    if (mCharge.spent() > 0)
+    {
+        mCharge.commit();
+        UpdateFunds(mBudget);
+    }
+}
@@ -0,0 +1,59 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#pragma once
+
+#include "Connection.h"
+#include "Point.h"
+#include "Tool.h"
+#include "Vector.h"
+
+#include <vector>
+
+class Budget;
+
+
+/**
+ * Group of tool actions applied as one edit.
+ *
+ * Every action in the batch draws on the same running charge and
+ * queues its road, rail and wire tiles on the same fixup. Nothing is
+ * joined up or taken from the budget until \c commit(), which the
+ * destructor calls if it hasn't been already.
+ *
+ * Doesn't touch the UI so it can be driven headless, e.g. by
+ * \c generateStressCity(), as well as from \c ToolDown().
+ */
+class ToolBatch
+{
+public:
+	ToolBatch() = delete;
+	ToolBatch(const ToolBatch&) = delete;
+	const ToolBatch& operator=(const ToolBatch&) = delete;
+
+	explicit ToolBatch(Budget& budget);
+	~ToolBatch();
+
+	ToolResult apply(const Tool tool, const Point<int>& location);
+
+	int rectangle(const Tool tool, const Point<int>& begin, const Point<int>& end);
+	int polyline(const Tool tool, const std::vector<Point<int>>& points);
+	int stamp(const Tool tool, const Point<int>& origin, const Vector<int>& spacing, const Vector<int>& count);
+
+	void commit();
+
+	ToolCharge& charge() { return mCharge; }
+	ConnectionFixup& fixup() { return mFixup; }
+
+private:
+	Budget& mBudget;
+	ToolCharge mCharge;
+	ConnectionFixup mFixup;
+};
@@ -14,6 +14,7 @@
 #include "Sprite.h"
 
 #include "s_alloc.h"
+#include "s_sim.h"
 #include "w_util.h"
 
 #include <algorithm>
@@ -25,9 +26,11 @@ namespace
 {
     constexpr auto MaxDistance = 30;
 
-    std::stack<Point<int>> CoordinatesStack;
+    thread_local std::stack<Point<int>> CoordinatesStack;
 
-    int Zsource;
+    thread_local int Zsource;
+
+    const TileMap* TrafficMapSource{ nullptr };
 
     const std::array<Vector<int>, 12> ZonePerimeterOffset =
     { {
@@ -59,11 +62,6 @@ namespace
         CoordinatesStack.push(coordinates);
     }
 
-    void popCoordinates()
-    {
-        CoordinatesStack.pop();
-    }
-
     void resetCoordinatesStack()
     {
         while (!CoordinatesStack.empty())
@@ -72,42 +70,54 @@ namespace
         }
     }
 
+    const TileMap& trafficMap()
+    {
+        return TrafficMapSource ? *TrafficMapSource : Map;
+    }
+
     void updateTrafficDensityMap()
     {
-        while (!CoordinatesStack.empty())
+        const auto target = SimulationTarget;
+        const auto trips = CoordinatesStack.size();
+        resetCoordinatesStack();
+
+        // Touches the shared density map and sprites so it's deferred during a parallel MapScan
+        deferSideEffect([target, trips]()
         {
-            popCoordinates();
-            if (CoordinatesValid(SimulationTarget))
+            for (size_t i = 0; i < trips; ++i)
             {
-                int tile = maskedTileValue(SimulationTarget);
-                if ((tile >= ROADBASE) && (tile < POWERBASE))
+                if (CoordinatesValid(target))
                 {
-                    /* check for rail */
-                    const Point<int> trafficDensityMapCoordinates = SimulationTarget.skewInverseBy({ 2, 2 });
-                    tile = TrafficDensityMap.value(trafficDensityMapCoordinates);
-                    tile += 50;
-
-                    if ((tile > ResidentialBase) && (RandomRange(0, 5) == 0))
+                    int tile = maskedTileValue(target);
+                    if ((tile >= ROADBASE) && (tile < POWERBASE))
                     {
-                        tile = ResidentialBase;
+                        /* check for rail */
+                        const Point<int> trafficDensityMapCoordinates = target.skewInverseBy({ 2, 2 });
+                        tile = TrafficDensityMap.value(trafficDensityMapCoordinates);
+                        tile += 50;
 
-                        SimSprite* sprite = getSprite(SimSprite::Type::Helicopter);
-                        if (sprite)
+                        if ((tile > ResidentialBase) && (RandomRange(0, 5) == 0))
                         {
-                            sprite->destination = SimulationTarget.skewBy({ 16, 16 });
+                            tile = ResidentialBase;
+
+                            SimSprite* sprite = getSprite(SimSprite::Type::Helicopter);
+                            if (sprite)
+                            {
+                                sprite->destination = target.skewBy({ 16, 16 });
+                            }
                         }
-                    }
 
-                    TrafficDensityMap.value(trafficDensityMapCoordinates) = tile;
+                        TrafficDensityMap.value(trafficDensityMapCoordinates) = tile;
+                    }
                 }
             }
-        }
+        });
     }
 
     int adjacentTile(size_t i)
     {
         const Point<int> coordinates{ SimulationTarget + AdjacentVector[i] };
-        return CoordinatesValid(coordinates) ? maskedTileValue(coordinates) : 0;
+        return CoordinatesValid(coordinates) ? maskedTileValue(trafficMap()[coordinates.x][coordinates.y]) : 0;
     }
 
     bool tryGo(int distance)
@@ -125,7 +135,7 @@ namespace
                 continue;
             }
 
-            if (tileIsRoad(SimulationTarget + AdjacentVector[direction]))
+            if (tileIsRoad(trafficMap(), SimulationTarget + AdjacentVector[direction]))
             {
                 moveSimulationTarget(static_cast<SearchDirection>(direction));
                 lastDirection = (direction + 2) % AdjacentVector.size();
@@ -194,6 +204,17 @@ namespace
 }
 
 
+/**
+ * Sets the map that route finding reads from. A parallel MapScan
+ * points this at a snapshot since routes reach into other strips.
+ * Pass nullptr to read the live map.
+ */
+void trafficMapSource(const TileMap* map)
+{
+    TrafficMapSource = map;
+}
+
+
 // look for road on edges of zone
 bool roadOnZonePerimeter()
 {
@@ -202,7 +223,7 @@ bool roadOnZonePerimeter()
         const Point<int> coordinates = SimulationTarget + ZonePerimeterOffset[i];
         if (CoordinatesValid(coordinates))
         {
-            if (tileIsRoad(coordinates))
+            if (tileIsRoad(trafficMap(), coordinates))
             {
                 SimulationTarget = coordinates;
                 return true;
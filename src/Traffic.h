@@ -10,6 +10,8 @@
 // file, included in this distribution, for details.
 #pragma once
 
+#include "Map.h"
+
 enum class TrafficResult
 {
 	NoTransportNearby,
@@ -20,3 +22,5 @@ enum class TrafficResult
 
 bool roadOnZonePerimeter();
 TrafficResult makeTraffic(int Zt);
+
+void trafficMapSource(const TileMap* map);
@@ -0,0 +1,66 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#pragma once
+
+#include <array>
+#include <atomic>
+
+
+/**
+ * Three buffers shared by one writer and one reader.
+ *
+ * The writer fills \c back() and calls \c publish(). The reader calls
+ * \c acquire() to pick up the newest published buffer and reads it
+ * through \c front(). Neither side ever waits for the other and the
+ * reader never sees a buffer while it's being written.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+	T& back() { return mBuffers[mBack]; }
+
+	/**
+	 * Hands the back buffer to the reader and takes whichever
+	 * buffer the reader isn't using as the new back buffer.
+	 */
+	void publish()
+	{
+		mBack = mMiddle.exchange(mBack | FreshBit, std::memory_order_acq_rel) & IndexMask;
+	}
+
+	/**
+	 * Returns true and moves the newest buffer to the front if
+	 * anything was published since the last call.
+	 */
+	bool acquire()
+	{
+		if ((mMiddle.load(std::memory_order_relaxed) & FreshBit) == 0)
+		{
+			return false;
+		}
+
+		mFront = mMiddle.exchange(mFront, std::memory_order_acq_rel) & IndexMask;
+		return true;
+	}
+
+	const T& front() const { return mBuffers[mFront]; }
+
+private:
+	static constexpr unsigned int IndexMask{ 0x3 };
+	static constexpr unsigned int FreshBit{ 0x4 };
+
+	std::array<T, 3> mBuffers{};
+
+	unsigned int mBack{ 0 };
+	std::atomic<unsigned int> mMiddle{ 1 };
+	unsigned int mFront{ 2 };
+};
@@ -18,6 +18,7 @@
 #include "CityProperties.h"
 #include "Map.h"
 #include "Power.h"
+#include "TileProperties.h"
 #include "Traffic.h"
 #include "Zone.h"
 
@@ -98,6 +99,8 @@ void zonePlop(const int base)
 
     setZonePower(SimulationTarget);
     tileValue(SimulationTarget) |= ZONEBIT + BULLBIT;
+
+    Zones.retype(SimulationTarget, base + 4);
 }
 
 
@@ -122,32 +125,11 @@ void plopIndustrial(int density, int value)
 }
 
 
-int residentialZonePopulation(int tile)
-{
-    const int density{ (((tile - RZB) / 9) % 4) };
-    return ((density * 8) + 16);
-}
-
-
-int commercialZonePopulation(int tile)
-{
-    const int density{ (((tile - CZB) / 9) % 5) + 1 };
-    return (tile == CommercialEmpty) ? 0 : density;
-}
-
-
-int industrialZonePopulation(int tile)
-{
-    const int density{ (((tile - IZB) / 9) % 4) + 1 };
-    return (tile == IndustryEmpty) ? 0 : density;
-}
-
-
 void spawnHospital()
 {
     if (CurrentTileMasked == HOSPITAL)
     {
-        HospPop++;
+        censusTally()[Census::Hospitals]++;
 
         if (!(CityTime % 16))/*post*/
         {
@@ -169,7 +151,7 @@ void spawnChurch()
 {
     if (CurrentTileMasked == CHURCH)
     {
-        ChurchPop++;
+        censusTally()[Census::Churches]++;
 
         if (!(CityTime & 16))/*post*/
         {
@@ -472,6 +454,7 @@ void increaseIndustry(int population, int value)
 void convertResidentialToHomes(int value)
 {
     tileValue(SimulationTarget) = ResidentialEmpty | BLBNCNBIT | ZONEBIT;
+    Zones.retype(SimulationTarget, ResidentialEmpty);
 
     for (int x{ SimulationTarget.x - 1 }; x <= SimulationTarget.x + 1; ++x)
     {
@@ -600,15 +583,15 @@ int housePopulation()
 }
 
 
-void updateIndustry(bool zonePowered)
+int updateIndustry(bool zonePowered)
 {
     int zscore;
 
     setSmoke(zonePowered);
 
-    int zonePopulation{ industrialZonePopulation(CurrentTileMasked) };
-    IndPop += zonePopulation;
-    IndZPop++;
+    int zonePopulation{ tileProperties(CurrentTileMasked).population };
+    censusTally()[Census::Industrial] += zonePopulation;
+    censusTally()[Census::IndustrialZones]++;
 
     TrafficResult trafficResult{ TrafficResult::RouteFound };
 
@@ -620,7 +603,7 @@ void updateIndustry(bool zonePowered)
     if (trafficResult == TrafficResult::NoTransportNearby)
     {
         decreaseIndustry(zonePopulation, RandomRange(0, 2));
-        return;
+        return zonePopulation;
     }
 
     if (!(RandomRange(0, 8)))
@@ -635,7 +618,7 @@ void updateIndustry(bool zonePowered)
         if ((zscore > -350) && (zscore - 26380) > Rand16())
         {
             increaseIndustry(zonePopulation, Rand16() & 1);
-            return;
+            return zonePopulation;
         }
 
         if ((zscore < 350) && (zscore + 26380) < Rand16())
@@ -643,18 +626,20 @@ void updateIndustry(bool zonePowered)
             decreaseIndustry(zonePopulation, Rand16() & 1);
         }
     }
+
+    return zonePopulation;
 }
 
 
-void updateCommercial(bool zonePowered)
+int updateCommercial(bool zonePowered)
 {
     int zscore, locvalve, value;
 
-    ComZPop++;
+    censusTally()[Census::CommercialZones]++;
 
-    int tpop = commercialZonePopulation(CurrentTileMasked);
+    int tpop = tileProperties(CurrentTileMasked).population;
 
-    ComPop += tpop;
+    censusTally()[Census::Commercial] += tpop;
 
     TrafficResult trafficResult{TrafficResult::RouteFound};
 
@@ -667,7 +652,7 @@ void updateCommercial(bool zonePowered)
     {
         value = getLandValue();
         decreaseCommercial(tpop, value);
-        return;
+        return tpop;
     }
 
     if (!(Rand16() & 7))
@@ -684,7 +669,7 @@ void updateCommercial(bool zonePowered)
         {
             value = getLandValue();
             increaseCommercial(tpop, value);
-            return;
+            return tpop;
         }
 
         if (zscore < 350 && zscore + 26380 < Rand16())
@@ -693,24 +678,27 @@ void updateCommercial(bool zonePowered)
             decreaseCommercial(tpop, value);
         }
     }
+
+    return tpop;
 }
 
 
-void updateResidential(bool zonePowered)
+int updateResidential(bool zonePowered)
 {
     int residentialPopulation, value;
 
-    if (CurrentTileMasked == ResidentialEmpty)
+    const auto& tile = tileProperties(CurrentTileMasked);
+    if (tile.has(TileProperties::CountsHouses))
     {
         residentialPopulation = housePopulation();
     }
     else
     {
-        residentialPopulation = residentialZonePopulation(CurrentTileMasked);
+        residentialPopulation = tile.population;
     }
 
-    ResZPop++;
-    ResPop += residentialPopulation;
+    censusTally()[Census::ResidentialZones]++;
+    censusTally()[Census::Residential] += residentialPopulation;
 
     TrafficResult trafficResult{ TrafficResult::RouteFound };
     if (residentialPopulation > RandomRange(0, 35))
@@ -722,7 +710,7 @@ void updateResidential(bool zonePowered)
     {
         value = getLandValue();
         decreaseResidential(residentialPopulation, value);
-        return;
+        return residentialPopulation;
     }
 
     if ((CurrentTileMasked == ResidentialEmpty) || (RandomRange(0, 8) == 0))
@@ -738,15 +726,20 @@ void updateResidential(bool zonePowered)
         {
             if ((!residentialPopulation) && (!(RandomRange(0, 4))))
             {
-                makeHospital();
-                makeChurch();
-                return;
+                // NeedHosp and NeedChurch are shared between MapScan strips
+                deferSideEffect([target = SimulationTarget]()
+                {
+                    SimulationTarget = target;
+                    makeHospital();
+                    makeChurch();
+                });
+                return residentialPopulation;
             }
 
             value = getLandValue();
             increaseResidential(residentialPopulation, value);
 
-            return;
+            return residentialPopulation;
         }
 
         if ((zoneScore < 350) && zoneScore + 26380 < Rand16())
@@ -755,40 +748,48 @@ void updateResidential(bool zonePowered)
             decreaseResidential(residentialPopulation, value);
         }
     }
+
+    return residentialPopulation;
 }
 
 
-void updateZone(const Point<int>& location, const CityProperties& properties)
+/**
+ * Updates a zone from the registry and caches its type, population
+ * and power in it.
+ */
+void updateZone(std::size_t zone, const CityProperties& properties)
 {
-    bool zonePowered{ setZonePower(location) };	
+    const auto location = Zones.location(zone);
 
-    zonePowered ? PoweredZoneCount++ : UnpoweredZoneCount++;
+    bool zonePowered{ setZonePower(location) };
 
-    if (CurrentTileMasked > PORTBASE) 
-    {
-        DoSPZone(zonePowered, properties);
-        return;
-    }
+    zonePowered ? censusTally()[Census::PoweredZones]++ : censusTally()[Census::UnpoweredZones]++;
 
-    if (CurrentTileMasked < HOSPITAL)
-    {
-        updateResidential(zonePowered);
-        return;
-    }
+    int population{};
 
-    if (CurrentTileMasked < COMBASE)
+    switch (tileProperties(CurrentTileMasked).tileClass)
     {
+    case TileClass::Residential:
+        population = updateResidential(zonePowered);
+        break;
+
+    case TileClass::Hospital:
         spawnHospital();
         spawnChurch();
-        return;
-    }
+        break;
 
-    if (CurrentTileMasked < INDBASE)
-    {
-        updateCommercial(zonePowered);
-        return;
+    case TileClass::Commercial:
+        population = updateCommercial(zonePowered);
+        break;
+
+    case TileClass::Industrial:
+        population = updateIndustry(zonePowered);
+        break;
+
+    default:
+        DoSPZone(zonePowered, properties);
+        break;
     }
 
-    updateIndustry(zonePowered);
-    return;
+    Zones.update(zone, maskedTileValue(location), population, zonePowered);
 }
@@ -10,11 +10,10 @@
 // file, included in this distribution, for details.
 #pragma once
 
+#include <cstddef>
+
 class CityProperties;
 
 int housePopulation();
-int residentialZonePopulation(int tile);
-int commercialZonePopulation(int tile);
-int industrialZonePopulation(int tile);
 bool setZonePower(const Point<int>& location);
-void updateZone(const Point<int>& location, const CityProperties&);
+void updateZone(std::size_t zone, const CityProperties&);
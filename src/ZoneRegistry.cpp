@@ -0,0 +1,177 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#include "ZoneRegistry.h"
+
+
+/**
+ * Adds the zone centre at \c location or, if it's already there,
+ * brings it back with its new type.
+ */
+void ZoneRegistry::add(const Point<int>& location, int type)
+{
+    const auto index = lowerBound(location);
+
+    if ((index < size()) && (location == this->location(index)))
+    {
+        update(index, type, 0, false);
+        return;
+    }
+
+    const auto offset = static_cast<std::ptrdiff_t>(index);
+
+    mX.insert(mX.begin() + offset, location.x);
+    mY.insert(mY.begin() + offset, location.y);
+    mType.insert(mType.begin() + offset, type);
+    mPopulation.insert(mPopulation.begin() + offset, 0);
+    mPowered.insert(mPowered.begin() + offset, 0);
+    mCensus.insert(mCensus.begin() + offset, CensusCounts{});
+}
+
+
+void ZoneRegistry::remove(const Point<int>& location)
+{
+    const auto index = find(location);
+    if (index < size())
+    {
+        update(index, Removed, 0, false);
+    }
+}
+
+
+/**
+ * A zone grew, declined or was rebuilt in place.
+ */
+void ZoneRegistry::retype(const Point<int>& location, int type)
+{
+    const auto index = find(location);
+    if (index < size())
+    {
+        mType[index] = type;
+    }
+}
+
+
+void ZoneRegistry::rebuild(const TileMap& map)
+{
+    mX.clear();
+    mY.clear();
+    mType.clear();
+    mPopulation.clear();
+    mPowered.clear();
+    mCensus.clear();
+
+    forEachTile([this, &map](const Point<int>& location)
+    {
+        const int tile = map[location.x][location.y];
+        if (tile & ZONEBIT)
+        {
+            mX.push_back(location.x);
+            mY.push_back(location.y);
+            mType.push_back(tile & LOMASK);
+            mPopulation.push_back(0);
+            mPowered.push_back((tile & PWRBIT) ? 1 : 0);
+            mCensus.push_back({});
+        }
+    });
+}
+
+
+/**
+ * Drops removed zones and any whose centre is no longer on the map.
+ *
+ * \return What the dropped zones still added to the census.
+ */
+CensusCounts ZoneRegistry::compact(const TileMap& map)
+{
+    CensusCounts dropped{};
+    std::size_t kept{ 0 };
+
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+        if (removed(i) || !(map[mX[i]][mY[i]] & ZONEBIT))
+        {
+            for (std::size_t counter = 0; counter < CensusCounterCount; ++counter)
+            {
+                dropped[counter] += mCensus[i][counter];
+            }
+            continue;
+        }
+
+        mX[kept] = mX[i];
+        mY[kept] = mY[i];
+        mType[kept] = mType[i];
+        mPopulation[kept] = mPopulation[i];
+        mPowered[kept] = mPowered[i];
+        mCensus[kept] = mCensus[i];
+        ++kept;
+    }
+
+    mX.resize(kept);
+    mY.resize(kept);
+    mType.resize(kept);
+    mPopulation.resize(kept);
+    mPowered.resize(kept);
+    mCensus.resize(kept);
+
+    return dropped;
+}
+
+
+/**
+ * Index of the first zone at or to the right of column \c x.
+ */
+std::size_t ZoneRegistry::firstInColumn(int x) const
+{
+    return lowerBound({ x, 0 });
+}
+
+
+void ZoneRegistry::update(std::size_t zone, int type, int population, bool powered)
+{
+    mType[zone] = type;
+    mPopulation[zone] = population;
+    mPowered[zone] = powered ? 1 : 0;
+}
+
+
+std::size_t ZoneRegistry::lowerBound(const Point<int>& location) const
+{
+    std::size_t first{ 0 };
+    std::size_t count{ size() };
+
+    while (count > 0)
+    {
+        const auto step = count / 2;
+        const auto middle = first + step;
+
+        if ((mX[middle] < location.x) || ((mX[middle] == location.x) && (mY[middle] < location.y)))
+        {
+            first = middle + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+
+    return first;
+}
+
+
+/**
+ * Index of the zone at \c location or size() if there isn't one.
+ */
+std::size_t ZoneRegistry::find(const Point<int>& location) const
+{
+    const auto index = lowerBound(location);
+    return ((index < size()) && (this->location(index) == location)) ? index : size();
+}
@@ -0,0 +1,65 @@
+// This file is part of Micropolis-SDL2PP
+// Micropolis-SDL2PP is based on Micropolis
+//
+// Copyright © 2022 Leeor Dicker
+//
+// Portions Copyright © 1989-2007 Electronic Arts Inc.
+//
+// Micropolis-SDL2PP is free software; you can redistribute it and/or modify
+// it under the terms of the GNU GPLv3, with additional terms. See the README
+// file, included in this distribution, for details.
+#pragma once
+
+#include "Census.h"
+#include "Map.h"
+#include "Point.h"
+
+#include <cstddef>
+#include <vector>
+
+
+/**
+ * Zone centres on the map, kept in MapScan order (by column, then row)
+ * with each field in its own array.
+ *
+ * Zones that are destroyed are only marked as removed so the registry
+ * can be read from several MapScan strips at once. They're dropped by
+ * \c compact() at the start of the next cycle.
+ */
+class ZoneRegistry
+{
+public:
+	void add(const Point<int>& location, int type);
+	void remove(const Point<int>& location);
+	void retype(const Point<int>& location, int type);
+
+	void rebuild(const TileMap& map);
+	CensusCounts compact(const TileMap& map);
+
+	std::size_t size() const { return mX.size(); }
+	std::size_t firstInColumn(int x) const;
+
+	Point<int> location(std::size_t zone) const { return { mX[zone], mY[zone] }; }
+	int type(std::size_t zone) const { return mType[zone]; }
+	int population(std::size_t zone) const { return mPopulation[zone]; }
+	bool powered(std::size_t zone) const { return mPowered[zone] != 0; }
+	bool removed(std::size_t zone) const { return mType[zone] == Removed; }
+
+	CensusCounts& census(std::size_t zone) { return mCensus[zone]; }
+	const CensusCounts& census(std::size_t zone) const { return mCensus[zone]; }
+
+	void update(std::size_t zone, int type, int population, bool powered);
+
+private:
+	static constexpr int Removed{ -1 };
+
+	std::size_t lowerBound(const Point<int>& location) const;
+	std::size_t find(const Point<int>& location) const;
+
+	std::vector<int> mX;
+	std::vector<int> mY;
+	std::vector<int> mType;
+	std::vector<int> mPopulation;
+	std::vector<char> mPowered; // not vector<bool>, strips write neighbouring zones at the same time
+	std::vector<CensusCounts> mCensus; // what the zone added to the census when last scanned
+};
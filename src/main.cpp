@@ -10,8 +10,10 @@
 // file, included in this distribution, for details.
 #include "main.h"
 
+#include "Autosave.h"
 #include "Budget.h"
 
+#include "BudgetAdvisor.h"
 #include "BudgetWindow.h"
 #include "Evaluation.h"
 #include "EvaluationWindow.h"
@@ -24,7 +26,9 @@
 #include "FileIo.h"
 #include "Font.h"
 #include "Graph.h"
+#include "Journal.h"
 #include "Map.h"
+#include "Rewind.h"
 #include "Tool.h"
 
 #include "g_ani.h"
@@ -37,8 +41,12 @@
 #include "s_sim.h"
 
 #include "Scan.h"
+#include "SimulationSnapshot.h"
+#include "SimulationThread.h"
 #include "Sprite.h"
+#include "StressCity.h"
 #include "StringRender.h"
+#include "TripleBuffer.h"
 
 #include "w_sound.h"
 #include "w_tk.h"
@@ -49,9 +57,12 @@
 #include "ToolPalette.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <iostream>
 #include <memory>
+#include <random>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -116,16 +127,26 @@ namespace
     Point<int> TilePointedAt{};
 
     bool Exit{ false };
-    bool RedrawMinimap{ false };
-    bool SimulationStep{ false };
+    std::atomic<bool> RedrawMinimap{ false };
+    std::atomic<bool> SimulationStep{ false };
     bool AnimationEnabled{ true };
-    bool AnimationStep{ false };
+    std::atomic<bool> AnimationStep{ false };
+    std::atomic<bool> BudgetWindowRequested{ false };
+    std::atomic<bool> BudgetAdviceRequested{ false };
+    bool BudgetNeededAttention{ false };
+    int CityLoads{ 0 };
     bool AutoBudget{ false };
     bool RightButtonDrag{ false };
 
     constexpr unsigned int SimStepDefaultTime{ 100 };
     constexpr unsigned int AnimationStepDefaultTime{ 150 };
 
+    constexpr std::size_t RewindYears{ 10 };
+
+    constexpr std::size_t BudgetAdvisorRuns{ 8 };
+    constexpr int BudgetAdvisorYears{ 2 };
+    constexpr std::chrono::milliseconds BudgetAdviceSlice{ 20 }; // at most, so posted commands aren't kept waiting
+
     SDL_Rect TileHighlight{ 0, 0, TileSize, TileSize };
 
     std::array<unsigned int, 5> SpeedModifierTable{ 0, 0, 50, 75, 95 };
@@ -146,6 +167,14 @@ namespace
     std::unique_ptr<StringRender> stringRenderer;
 
     std::unique_ptr<FileIo> fileIo;
+    std::unique_ptr<Autosave> autosave;
+    std::unique_ptr<Journal> journal;
+    std::unique_ptr<Rewind> rewindHistory;
+    std::unique_ptr<BudgetAdvisor> budgetAdvisor;
+    std::vector<std::string> BudgetAdvice; // shown under the top bar until dismissed
+
+    std::unique_ptr<SimulationThread> simulationThread;
+    TripleBuffer<SimulationSnapshot> Snapshots;
 
     std::unique_ptr<Font> MainFont;
     std::unique_ptr<Font> MainBigFont;
@@ -171,12 +200,14 @@ namespace
     unsigned int simulationTick(unsigned int interval, void*)
     {
         SimulationStep = true;
+        simulationThread->wake();
         return SimStepDefaultTime - speedModifier();
     }
 
     unsigned int animationTick(unsigned int interval, void*)
     {
         AnimationStep = true;
+        simulationThread->wake();
         return interval;
     }
 
@@ -214,10 +245,13 @@ const Point<int>& viewOffset()
 }
 
 
+/**
+ * Called from the simulation thread, the window is opened by the
+ * UI thread and the simulation doesn't step until it is.
+ */
 void showBudgetWindow()
 {
-    budgetWindow->show();
-    budgetWindow->update();
+    BudgetWindowRequested = true;
 }
 
 
@@ -266,22 +300,117 @@ void simExit()
 void simUpdate()
 {
     updateDate();
+}
 
-    if (newMonth() && graphWindow->visible()) { graphWindow->update(); }
 
-    scoreDoer(cityProperties);
+/**
+ * Carries out a command on the simulation thread, or while it's
+ * held, recording it first if a journal is open.
+ */
+void runCommand(const Journal::Entry& entry)
+{
+    if (journal) { journal->record(entry); }
+    Journal::apply(entry, budget);
 }
 
 
-void simLoop(bool doSim)
+/**
+ * Publishes the current simulation state to the UI. Only called
+ * from the simulation thread or while it's held.
+ */
+void publishSnapshot()
 {
-    // \fixme Find a better way to do this
-    if (budgetWindow->visible()) { return; }
+    takeSnapshot(Snapshots.back(), budget);
+    Snapshots.back().cityLoads = CityLoads;
+    Snapshots.back().budgetAdvice = BudgetAdvice;
+    Snapshots.publish();
+}
+
+
+/**
+ * Tells the UI that the whole city was replaced so it redraws all
+ * of it rather than only what's in view.
+ */
+void cityReplaced()
+{
+    ++CityLoads;
+    publishSnapshot();
+}
+
 
-    if (doSim)
+/**
+ * Replaces the running city on the simulation thread with whatever
+ * \c load puts in place. The journal and the rewind history belong
+ * to the old city and are dropped.
+ */
+void replaceCity(std::function<void()> load)
+{
+    simulationThread->post([load]
+    {
+        journal.reset();
+        rewindHistory->clear();
+        budgetAdvisor->cancel();
+        BudgetAdvice.clear();
+
+        load();
+
+        cityReplaced();
+    });
+}
+
+
+/**
+ * Runs on the simulation thread every time it's woken up.
+ */
+void simulationStep()
+{
+    if (BudgetWindowRequested) { return; }
+
+    if (SimulationStep)
     {
-        SimFrame(cityProperties, budget);
         SimulationStep = false;
+        SimFrame(cityProperties, budget);
+
+        // Scored straight after the frame so a replay draws the same random numbers.
+        scoreDoer(cityProperties);
+
+        if (journal) { journal->frame(); }
+
+        if (autosave->due())
+        {
+            autosave->save(cityProperties, budget);
+        }
+
+        rewindHistory->capture(cityProperties, budget);
+    }
+
+    // Waits for a tick boundary, the city can't be cloned part way through a phase.
+    if (BudgetAdviceRequested && (budgetAdvisor->running() || budgetAdvisor->start(BudgetAdvisor::settingsAround(budget), cityProperties, budget)))
+    {
+        BudgetAdviceRequested = false;
+    }
+
+    // Only uses the time the live city leaves idle and comes straight back for more.
+    if (budgetAdvisor->running())
+    {
+        if (budgetAdvisor->advance(BudgetAdviceSlice, cityProperties, budget, [] { return simulationThread->stepWaiting(); }))
+        {
+            BudgetAdvice = budgetAdvisor->report();
+        }
+        else
+        {
+            BudgetAdvice =
+            {
+                "Working out budget advice, " + std::to_string(budgetAdvisor->runsDone()) + " of " + std::to_string(budgetAdvisor->runCount()) + " runs done",
+                "Tries tax rates up to 2% either side of the current one, with current and full funding",
+                "Runs one at a time while the city is idle between steps, Esc stops it"
+            };
+
+            if (!budgetAdvisor->waitingForLiveCity())
+            {
+                simulationThread->wake();
+            }
+        }
     }
 
     if (AnimationStep)
@@ -290,10 +419,85 @@ void simLoop(bool doSim)
 
         if (!Paused())
         {
-            animateTiles();
-            updateSprites();
+            runCommand({ Journal::Command::Animation });
         }
+    }
+
+    simUpdate();
+    newMap(false);
+
+    publishSnapshot();
+}
+
+
+const SimulationSnapshot& snapshot()
+{
+    return Snapshots.front();
+}
+
+
+void budgetWindowVisible(const bool visible)
+{
+    if (budgetWindow->visible() == visible) { return; }
+
+    if (visible)
+    {
+        simulationThread->hold();
+        budgetWindow->show();
+        budgetWindow->update();
+    }
+    else
+    {
+        budgetWindow->hide();
+        if (journal) { journal->record(Journal::budgetEntry(budget)); }
+        simulationThread->release();
+    }
+}
+
+
+void linkSnapshot(const SimulationSnapshot& snapshot)
+{
+    miniMapWindow->linkTileMap(snapshot.map);
+
+    miniMapWindow->linkEffectMap(MiniMapWindow::ButtonId::Crime, snapshot.crimeMap);
+    miniMapWindow->linkEffectMap(MiniMapWindow::ButtonId::FireProtection, snapshot.fireProtectionMap);
+    miniMapWindow->linkEffectMap(MiniMapWindow::ButtonId::LandValue, snapshot.landValueMap);
+    miniMapWindow->linkEffectMap(MiniMapWindow::ButtonId::PoliceProtection, snapshot.policeProtectionMap);
+    miniMapWindow->linkEffectMap(MiniMapWindow::ButtonId::Pollution, snapshot.pollutionMap);
+    miniMapWindow->linkEffectMap(MiniMapWindow::ButtonId::PopulationDensity, snapshot.populationDensityMap);
+    miniMapWindow->linkEffectMap(MiniMapWindow::ButtonId::PopulationGrowth, snapshot.rateOfGrowthMap);
+    miniMapWindow->linkEffectMap(MiniMapWindow::ButtonId::TrafficDensity, snapshot.trafficDensityMap);
+
+    graphWindow->linkHistory(GraphWindow::ButtonId::Residential, snapshot.residentialHistory);
+    graphWindow->linkHistory(GraphWindow::ButtonId::Commercial, snapshot.commercialHistory);
+    graphWindow->linkHistory(GraphWindow::ButtonId::Industrial, snapshot.industrialHistory);
+    graphWindow->linkHistory(GraphWindow::ButtonId::Money, snapshot.moneyHistory);
+    graphWindow->linkHistory(GraphWindow::ButtonId::Crime, snapshot.crimeHistory);
+    graphWindow->linkHistory(GraphWindow::ButtonId::Pollution, snapshot.pollutionHistory);
+}
+
+
+/**
+ * Picks up the newest snapshot, if there is one, and redraws
+ * whatever depends on it.
+ */
+void updateFromSnapshot()
+{
+    const int lastMonth = snapshot().month;
+    const int lastYear = snapshot().year;
+    const int lastCityLoads = snapshot().cityLoads;
+
+    if (!Snapshots.acquire()) { return; }
+
+    linkSnapshot(snapshot());
 
+    if (snapshot().cityLoads != lastCityLoads)
+    {
+        DrawBigMapSegment(snapshot().map, Point<int>{ 0, 0 }, Point<int>{ SimWidth, SimHeight });
+        RedrawMinimap = true;
+    }
+    else
+    {
         const Point<int> begin{ MapViewOffset.x / TileSize, MapViewOffset.y / TileSize };
         const Point<int> end
         {
@@ -301,16 +505,20 @@ void simLoop(bool doSim)
             std::clamp((MapViewOffset.y + WindowSize.y) / TileSize + 1, 0, SimHeight)
         };
 
-        DrawBigMapSegment(begin, end);
+        DrawBigMapSegment(snapshot().map, begin, end);
     }
 
-    if (RedrawMinimap)
+    if ((snapshot().month != lastMonth || snapshot().year != lastYear) && graphWindow->visible())
     {
-        miniMapWindow->draw();
-        RedrawMinimap = false;
+        graphWindow->update();
     }
 
-    simUpdate();
+    if (snapshot().budgetNeedsAttention && !BudgetNeededAttention)
+    {
+        budgetWindowVisible(true);
+    }
+
+    BudgetNeededAttention = snapshot().budgetNeedsAttention;
 }
 
 
@@ -335,6 +543,7 @@ void initWillStuff()
 
 void simInit()
 {
+    SeedRandom(std::random_device{}());
     userSoundOn(true);
 
     ScenarioID = 0;
@@ -456,6 +665,7 @@ void loadGraphics()
 {
     buildBigTileset();
     RCI_Indicator = loadTexture(MainWindowRenderer, "images/demandg.xpm");
+    loadSpriteTextures();
 }
 
 
@@ -547,40 +757,106 @@ void calculateMouseToWorld()
 }
 
 
+void changeSpeed(const SimulationSpeed speed)
+{
+    runCommand({ Journal::Command::Speed, { static_cast<int>(speed) } });
+}
+
+
+/**
+ * Starts recording a journal from the current city, or stops the
+ * one being recorded.
+ */
+void toggleJournal()
+{
+    simulationThread->post([path = fileIo->journalPath()]
+    {
+        if (journal)
+        {
+            journal.reset();
+            std::cout << "Journal closed" << std::endl;
+            return;
+        }
+
+        try
+        {
+            journal = std::make_unique<Journal>(path, cityProperties, budget);
+            std::cout << "Recording a journal to '" << path << "'" << std::endl;
+        }
+        catch (const std::runtime_error& error)
+        {
+            std::cout << error.what() << std::endl;
+        }
+
+        // The journal starts from a saved and reloaded copy of the city.
+        cityReplaced();
+    });
+}
+
+
+/**
+ * Moves \c months through the rewind history and pauses on the
+ * month found there. Unpausing carries on from it.
+ */
+void scrubRewind(const int months)
+{
+    simulationThread->post([months]
+    {
+        const int target = static_cast<int>(rewindHistory->position()) + months;
+        if (target < 0 || target >= static_cast<int>(rewindHistory->size()))
+        {
+            return;
+        }
+
+        journal.reset();
+
+        if (rewindHistory->restore(static_cast<std::size_t>(target), cityProperties, budget))
+        {
+            Pause();
+            cityReplaced();
+
+            const int cityTime = rewindHistory->cityTime(static_cast<std::size_t>(target));
+            std::cout << "Rewound to " << MonthString(static_cast<Month>((cityTime % 48) / 4)) << " " << cityTime / 48 + StartingYear << std::endl;
+        }
+    });
+}
+
+
 void handleKeyEvent(SDL_Event& event)
 {
     switch (event.key.keysym.sym)
     {
     case SDLK_ESCAPE:
-        budgetWindow->hide();
+        budgetWindowVisible(false);
         evaluationWindow->hide();
         graphWindow->hide();
+        simulationThread->post([]
+        {
+            budgetAdvisor->cancel();
+            BudgetAdvice.clear();
+        });
         break;
 
     case SDLK_0:
     case SDLK_p:
     case SDLK_SPACE:
-        Paused() ? Resume() : Pause();
+        simulationThread->post([] { runCommand({ Paused() ? Journal::Command::Resume : Journal::Command::Pause }); });
         break;
 
     case SDLK_1:
-        if (Paused()) { Resume(); }
-        SimSpeed(SimulationSpeed::Slow);
+        simulationThread->post([] { changeSpeed(SimulationSpeed::Slow); });
         break;
 
     case SDLK_2:
-        if (Paused()) { Resume(); }
-        SimSpeed(SimulationSpeed::Normal);
+        simulationThread->post([] { changeSpeed(SimulationSpeed::Normal); });
         break;
 
     case SDLK_3:
-        if (Paused()) { Resume(); }
-        SimSpeed(SimulationSpeed::Fast);
+        simulationThread->post([] { changeSpeed(SimulationSpeed::Fast); });
         break;
 
     case SDLK_4:
-        if (Paused()) { Resume(); }
-        SimSpeed(SimulationSpeed::AfricanSwallow);
+        simulationThread->post([] { changeSpeed(SimulationSpeed::AfricanSwallow); });
         break;
 
     case SDLK_F2:
@@ -592,15 +868,19 @@ void handleKeyEvent(SDL_Event& event)
             }
         }
 
+        simulationThread->hold();
         SaveCity(fileIo->fullPath(), cityProperties, budget);
+        simulationThread->release();
         break;
 
     case SDLK_F3:
         if (fileIo->pickOpenFile())
         {
-            resetGame();
-            LoadCity(fileIo->fullPath(), cityProperties, budget);
-            DrawBigMap();
+            replaceCity([path = fileIo->fullPath()]
+            {
+                resetGame();
+                LoadCity(path, cityProperties, budget);
+            });
         }
         break;
 
@@ -616,9 +896,24 @@ void handleKeyEvent(SDL_Event& event)
         //MakeFire();
         break;
 
+    case SDLK_F6:
+        simulationThread->post([] { runCommand({ Journal::Command::ParallelSimulation, { !parallelSimulation() } }); });
+        break;
+
     case SDLK_F7:
-        resetGame();
-        DrawBigMap();
+        replaceCity(&resetGame);
+        break;
+
+    case SDLK_F8:
+        toggleJournal();
+        break;
+
+    case SDLK_LEFTBRACKET:
+        scrubRewind(-1);
+        break;
+
+    case SDLK_RIGHTBRACKET:
+        scrubRewind(1);
         break;
 
     case SDLK_F9:
@@ -627,8 +922,11 @@ void handleKeyEvent(SDL_Event& event)
         break;
 
     case SDLK_F10:
-        budgetWindow->toggleVisible();
-        if (budgetWindow->visible()) { budgetWindow->update(); }
+        budgetWindowVisible(!budgetWindow->visible());
+        break;
+
+    case SDLK_F11:
+        BudgetAdviceRequested = true;
         break;
             
     case SDLK_F1:
@@ -660,7 +958,7 @@ void handleMouseEvent(SDL_Event& event)
         if (pendingToolProperties().draggable && EventHandling::MouseLeftDown && toolStart() != TilePointedAt)
         {
             DraggableToolVector = vectorFromPoints(toolStart(), TilePointedAt);
-            validateDraggableToolVector(DraggableToolVector, budget);
+            validateDraggableToolVector(DraggableToolVector, snapshot());
         }
 
         calculateMouseToWorld();
@@ -691,7 +989,7 @@ void handleMouseEvent(SDL_Event& event)
 
             toolStart(TilePointedAt);
 
-            if (budgetWindow->area().contains(mousePosition))
+            if (budgetWindow->visible() && budgetWindow->area().contains(mousePosition))
             {
                 budgetWindow->injectMouseDown(mousePosition);
             }
@@ -703,7 +1001,12 @@ void handleMouseEvent(SDL_Event& event)
 
             if (!budgetWindow->visible() && !pendingToolProperties().draggable)
             {
-                ToolDown(TilePointedAt, budget);
+                const Tool tool = pendingTool();
+                const Point<int> location = TilePointedAt;
+                simulationThread->post([tool, location]
+                {
+                    runCommand({ Journal::Command::ToolDown, { static_cast<int>(tool), location.x, location.y } });
+                });
             }
         }
         break;
@@ -731,7 +1034,16 @@ void handleMouseEvent(SDL_Event& event)
             
             if (pendingToolProperties().draggable)
             {
-                executeDraggableTool(DraggableToolVector, TilePointedAt, budget);
+                const Tool tool = pendingTool();
+                const Point<int> origin = toolStart();
+                const Point<int> location = TilePointedAt;
+                const Vector<int> toolVector = DraggableToolVector;
+
+                simulationThread->post([tool, origin, location, toolVector]
+                {
+                    runCommand({ Journal::Command::DragTool,
+                        { static_cast<int>(tool), origin.x, origin.y, toolVector.x, toolVector.y, location.x, location.y } });
+                });
             }
         }
         else if (event.button.button == SDL_BUTTON_RIGHT)
@@ -860,9 +1172,9 @@ void initViewParamters()
 
 void drawValve()
 {
-    double residentialPercent = static_cast<double>(RValve) / 1500.0;
-    double commercialPercent = static_cast<double>(CValve) / 1500.0;
-    double industrialPercent = static_cast<double>(IValve) / 1500.0;
+    double residentialPercent = static_cast<double>(snapshot().residentialValve) / 1500.0;
+    double commercialPercent = static_cast<double>(snapshot().commercialValve) / 1500.0;
+    double industrialPercent = static_cast<double>(snapshot().industrialValve) / 1500.0;
 
     ResidentialValveRect.h = -static_cast<int>(RciValveHeight * residentialPercent);
     CommercialValveRect.h = -static_cast<int>(RciValveHeight * commercialPercent);
@@ -896,16 +1208,50 @@ void drawTopUi()
     SDL_RenderCopy(MainWindowRenderer, RCI_Indicator.texture, nullptr, &RciDestination);
     drawValve();
 
-    stringRenderer->drawString(*MainBigFont, MonthString(static_cast<Month>(LastCityMonth())), {UiHeaderRect.x + 5, UiHeaderRect.y + 5});
-    stringRenderer->drawString(*MainBigFont, std::to_string(CurrentYear()), { UiHeaderRect.x + 35, UiHeaderRect.y + 5});
+    stringRenderer->drawString(*MainBigFont, MonthString(static_cast<Month>(snapshot().month)), {UiHeaderRect.x + 5, UiHeaderRect.y + 5});
+    stringRenderer->drawString(*MainBigFont, std::to_string(snapshot().year), { UiHeaderRect.x + 35, UiHeaderRect.y + 5});
 
-    stringRenderer->drawString(*MainBigFont, LastMessage(), {100, UiHeaderRect.y + 5});
+    stringRenderer->drawString(*MainBigFont, snapshot().message, {100, UiHeaderRect.y + 5});
 
     const Point<int> budgetPosition{ UiHeaderRect.x + UiHeaderRect.w - 5 - MainBigFont->width(currentBudget), UiHeaderRect.y + 5 };
     stringRenderer->drawString(*MainBigFont, currentBudget, budgetPosition);
 }
 
 
+/**
+ * Budget advice, or how far along working it out is, under the top bar.
+ */
+void drawBudgetAdvice()
+{
+    const auto& lines = snapshot().budgetAdvice;
+    if (lines.empty()) { return; }
+
+    int width{ 0 };
+    for (const auto& line : lines)
+    {
+        width = std::max(width, MainFont->width(line));
+    }
+
+    const SDL_Rect rect
+    {
+        UiHeaderRect.x + UiHeaderRect.w - width - 10,
+        UiHeaderRect.y + UiHeaderRect.h + 5,
+        width + 10,
+        static_cast<int>(lines.size()) * MainFont->height() + 10
+    };
+
+    SDL_SetRenderDrawColor(MainWindowRenderer, 0, 0, 0, 150);
+    SDL_RenderFillRect(MainWindowRenderer, &rect);
+    SDL_SetRenderDrawColor(MainWindowRenderer, 0, 0, 0, 255);
+    SDL_RenderDrawRect(MainWindowRenderer, &rect);
+
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+        stringRenderer->drawString(*MainFont, lines[i], { rect.x + 5, rect.y + 5 + static_cast<int>(i) * MainFont->height() });
+    }
+}
+
+
 void DrawPendingTool(const ToolPalette& palette)
 {
     if (palette.tool() == Tool::None || (pendingToolProperties().draggable && EventHandling::MouseLeftDown))
@@ -973,7 +1319,6 @@ void gameInit()
     primeGame(-1, cityProperties, budget);
 
     updateMapDrawParameters();
-    initTimers();
 }
 
 
@@ -995,16 +1340,10 @@ void initUI()
     miniMapWindow->updateViewportSize(WindowSize);
     miniMapWindow->focusOnMapCoordBind(&minimapViewUpdated);
 
-    miniMapWindow->linkEffectMap(MiniMapWindow::ButtonId::Crime, CrimeMap);
-    miniMapWindow->linkEffectMap(MiniMapWindow::ButtonId::FireProtection, FireProtectionMap);
-    miniMapWindow->linkEffectMap(MiniMapWindow::ButtonId::LandValue, LandValueMap);
-    miniMapWindow->linkEffectMap(MiniMapWindow::ButtonId::PoliceProtection, PoliceProtectionMap);
-    miniMapWindow->linkEffectMap(MiniMapWindow::ButtonId::Pollution, PollutionMap);
-    miniMapWindow->linkEffectMap(MiniMapWindow::ButtonId::PopulationDensity, PopulationDensityMap);
-    miniMapWindow->linkEffectMap(MiniMapWindow::ButtonId::PopulationGrowth, RateOfGrowthMap);
-    miniMapWindow->linkEffectMap(MiniMapWindow::ButtonId::TrafficDensity, TrafficDensityMap);
-
     fileIo = std::make_unique<FileIo>(*MainWindow);
+    autosave = std::make_unique<Autosave>(fileIo->autosavePath(), std::chrono::minutes(5));
+    rewindHistory = std::make_unique<Rewind>(RewindYears);
+    budgetAdvisor = std::make_unique<BudgetAdvisor>(BudgetAdvisorRuns, BudgetAdvisorYears);
 
     stringRenderer = std::make_unique<StringRender>(MainWindowRenderer);
     toolPalette = std::make_unique<ToolPalette>(MainWindowRenderer);
@@ -1027,6 +1366,11 @@ void initUI()
 void cleanUp()
 {
     deinitTimers();
+    simulationThread.reset();
+    journal.reset();
+    rewindHistory.reset();
+    budgetAdvisor.reset();
+    autosave.reset();
 
     SDL_DestroyTexture(BigTileset.texture);
     SDL_DestroyTexture(RCI_Indicator.texture);
@@ -1036,26 +1380,49 @@ void cleanUp()
 }
 
 
+/**
+ * The simulation runs on its own thread. The UI never touches
+ * simulation state directly, it draws from the latest snapshot
+ * and posts tool use, speed changes and city loads as commands.
+ */
 void GameLoop()
 {
-    miniMapWindow->draw();
-    DrawBigMap();
+    simulationThread = std::make_unique<SimulationThread>(&simulationStep);
+
+    replaceCity([] { LoadScenario(Scenario::Dullsville, cityProperties, budget); });
+    simulationThread->wake();
+
+    initTimers();
 
     while (!Exit)
     {
-        pendingTool(toolPalette->tool());
+        simulationThread->rethrowException();
 
-        simLoop(SimulationStep);
+        pendingTool(toolPalette->tool());
 
         pumpEvents();
 
-        currentBudget = NumberToDollarDecimal(budget.CurrentFunds());
+        if (BudgetWindowRequested)
+        {
+            budgetWindowVisible(true);
+            BudgetWindowRequested = false;
+        }
+
+        updateFromSnapshot();
+
+        if (RedrawMinimap)
+        {
+            miniMapWindow->draw();
+            RedrawMinimap = false;
+        }
+
+        currentBudget = NumberToDollarDecimal(snapshot().funds);
 
         SDL_RenderClear(MainWindowRenderer);
         SDL_RenderCopy(MainWindowRenderer, MainMapTexture.texture, &FullMapViewRect, nullptr);
-        drawSprites();
+        drawSprites(snapshot().sprites);
 
-        if (budget.NeedsAttention() || budgetWindow->visible())
+        if (snapshot().budgetNeedsAttention || budgetWindow->visible())
         {
             SDL_SetRenderDrawColor(MainWindowRenderer, 0, 0, 0, 175);
             SDL_RenderFillRect(MainWindowRenderer, nullptr);
@@ -1064,7 +1431,7 @@ void GameLoop()
             if (budgetWindow->accepted())
             {
                 budgetWindow->reset();
-                budgetWindow->hide();
+                budgetWindowVisible(false);
             }
         }
         else
@@ -1073,6 +1440,7 @@ void GameLoop()
             drawDraggableToolVector();
 
             drawTopUi();
+            drawBudgetAdvice();
 
             if (EventHandling::MouseClicked)
             {
@@ -1087,8 +1455,6 @@ void GameLoop()
 
         SDL_RenderPresent(MainWindowRenderer);
         miniMapWindow->drawUI();
-
-        newMap(false);
     }
 }
 
@@ -1103,6 +1469,19 @@ int main(int argc, char* argv[])
 
     try
     {
+        if (argc > 2 && std::string(argv[1]) == "--replay")
+        {
+            simInit();
+            return Journal::replay(argv[2], cityProperties, budget) ? 0 : 1;
+        }
+
+        if (argc > 2 && std::string(argv[1]) == "--generate")
+        {
+            simInit();
+            generateStressCity(argv[2], argc > 3 ? static_cast<std::uint32_t>(std::stoul(argv[3])) : 0, cityProperties, budget);
+            return 0;
+        }
+
         if (SDL_Init(SDL_INIT_EVERYTHING))
         {
             throw std::runtime_error(std::string("Unable to initialize SDL: ") + SDL_GetError());
@@ -1117,8 +1496,6 @@ int main(int argc, char* argv[])
 
         gameInit();
 
-        LoadScenario(Scenario::Dullsville, cityProperties, budget);
-
         GameLoop();
 
         cleanUp();
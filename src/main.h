@@ -50,15 +50,19 @@ constexpr auto MiscHistoryLength = 240;
 #define BLBNCNBIT	(BULLBIT+BURNBIT+CONDBIT)
 #define BNCNBIT		(BURNBIT+CONDBIT)
 
-extern int CurrentTile; // unmasked tile value
-extern int CurrentTileMasked; // masked tile value
+// Per thread so that MapScan strips can run on worker threads.
+extern thread_local int CurrentTile; // unmasked tile value
+extern thread_local int CurrentTileMasked; // masked tile value
 
+// Census counters filled in by MapScan, see censusCounters().
 extern int RoadTotal, RailTotal, FirePop;
-extern int ResPop, ComPop, IndPop, TotalPop, LastTotalPop;
-extern int ResZPop, ComZPop, IndZPop, TotalZPop;
+extern int ResPop, ComPop, IndPop;
+extern int ResZPop, ComZPop, IndZPop;
 extern int HospPop, ChurchPop, StadiumPop;
 extern int PolicePop, FireStPop;
 extern int CoalPop, NuclearPop, PortPop, APortPop;
+
+extern int TotalPop, LastTotalPop, TotalZPop;
 extern int NeedHosp, NeedChurch;
 extern int CrimeAverage, PolluteAverage, LVAverage;
 
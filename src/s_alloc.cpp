@@ -13,6 +13,7 @@
 #include "EffectMap.h"
 #include "main.h"
 #include "Power.h"
+#include "Scan.h"
 
 #include "w_util.h"
 
@@ -23,19 +24,21 @@
 
 /* Allocate Stuff */
 
-Point<int> SimulationTarget{};
+thread_local Point<int> SimulationTarget{};
 
-int CurrentTile; // unmasked tile value
-int CurrentTileMasked; // masked tile value
+thread_local int CurrentTile; // unmasked tile value
+thread_local int CurrentTileMasked; // masked tile value
 
 int RoadTotal, RailTotal, FirePop;
 
-int ResPop, ComPop, IndPop, TotalPop, LastTotalPop;
-int ResZPop, ComZPop, IndZPop, TotalZPop; // zone counts
+int ResPop, ComPop, IndPop;
+int ResZPop, ComZPop, IndZPop; // zone counts
 int HospPop, ChurchPop, StadiumPop;
 int PolicePop, FireStPop;
 int CoalPop, NuclearPop, PortPop, APortPop;
 
+int TotalPop, LastTotalPop, TotalZPop;
+
 int NeedHosp, NeedChurch;
 int CrimeAverage, PolluteAverage, LVAverage;
 
@@ -66,6 +69,8 @@ EffectMap FireProtectionMap({ EighthWorldWidth, EighthWorldHeight });
 
 EffectMap ComRate({ EighthWorldWidth, EighthWorldHeight });
 
+ZoneRegistry Zones;
+
 GraphHistory ResHis{};
 GraphHistory ComHis{};
 GraphHistory IndHis{};
@@ -140,6 +145,7 @@ void initMapArrays()
     resetHalfArrays();
     resetQuarterArrays();
     resetHistoryArrays();
+    resetPollutionScan();
 }
 
 
@@ -13,6 +13,7 @@
 #include "EffectMap.h"
 #include "main.h"
 #include "Point.h"
+#include "ZoneRegistry.h"
 
 #include <array>
 
@@ -22,7 +23,7 @@ enum class SearchDirection
 };
 
 
-extern Point<int> SimulationTarget;
+extern thread_local Point<int> SimulationTarget;
 
 
 // 2X2 Maps  60 x 50
@@ -45,6 +46,8 @@ extern EffectMap FireProtectionMap;
 
 extern EffectMap ComRate;
 
+extern ZoneRegistry Zones;
+
 using GraphHistory = std::array<int, HistoryLength>;
 
 extern GraphHistory ResHis;
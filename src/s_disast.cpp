@@ -18,6 +18,7 @@
 
 #include "Scan.h"
 #include "Sprite.h"
+#include "TileProperties.h"
 
 #include "w_util.h"
 
@@ -38,8 +39,7 @@ bool tileIsArsonable(const int tile)
 
 bool tileIsRiverEdge(const int tile)
 {
-    const int masked = tile & LOMASK;
-    return masked >= FIRSTRIVEDGE && masked <= LASTRIVEDGE;
+    return tileProperties(tile).has(TileProperties::RiverEdge);
 }
 
 
@@ -190,6 +190,16 @@ void MakeFlood()
 }
 
 
+bool floodActive()
+{
+    return FloodCount > 0;
+}
+
+
+/**
+ * Spreads the flood at SimulationTarget while the flood lasts, then
+ * lets it recede. How often this runs is up to the active tile wheel.
+ */
 void DoFlood()
 {
     static int Dx[4] = { 0, 1, 0,-1 };
@@ -221,10 +231,7 @@ void DoFlood()
     }
     else
     {
-        if (RandomRange(0, 15) == 0)
-        {
-            Map[SimulationTarget.x][SimulationTarget.y] = 0;
-        }
+        Map[SimulationTarget.x][SimulationTarget.y] = 0;
     }
 }
 
@@ -12,8 +12,12 @@
 
 class CityProperties;
 
+extern int FloodCount;
+extern int FloodX, FloodY;
+
 void DoDisasters(CityProperties&);
 void DoFlood();
+bool floodActive();
 
 void MakeEarthquake();
 void MakeFire();
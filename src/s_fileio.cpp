@@ -11,6 +11,7 @@
 #include "main.h"
 
 #include "Budget.h"
+#include "CityFile.h"
 #include "CityProperties.h"
 #include "Map.h"
 
@@ -24,11 +25,20 @@
 #include "w_util.h"
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <limits>
 #include <map>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
 
 
 namespace
@@ -54,129 +64,1032 @@ namespace
         { Scenario::Rio, { "snro.888", "Rio de Janeiro", ((2047 - 1900) * 48) + 2, 20000, 8 } }
     };
 
-    void copyBufIntoArray(const int (&buf)[HistoryLength], GraphHistory& graph)
+    /**
+     * Cities saved by this port hold seven histories of native ints
+     * followed by the map.
+     */
+    constexpr std::size_t NativeFileSize{ (7 * sizeof(GraphHistory)) + sizeof(TileMap) };
+
+    /**
+     * Cities saved by the original game hold 16 bit big endian words:
+     * six histories that each cover both the 10 and 120 year graphs,
+     * the misc history and then the map.
+     */
+    constexpr std::size_t ClassicHistoryWords{ HistoryLength * 2 };
+    constexpr std::size_t ClassicMiscOffset{ 6 * ClassicHistoryWords };
+    constexpr std::size_t ClassicMapOffset{ ClassicMiscOffset + HistoryLength };
+    constexpr std::size_t ClassicFileSize{ (ClassicMapOffset + (SimWidth * SimHeight)) * 2 };
+
+
+    std::vector<unsigned char> readFile(const std::string& filename)
+    {
+        std::ifstream infile(filename, std::ifstream::binary | std::ifstream::ate);
+        if (infile.fail())
+        {
+            return {};
+        }
+
+        std::vector<unsigned char> buffer(static_cast<std::size_t>(infile.tellg()));
+        infile.seekg(0);
+        infile.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+
+        return infile ? buffer : std::vector<unsigned char>{};
+    }
+
+
+    void loadNative(const std::vector<unsigned char>& buffer)
+    {
+        const unsigned char* source = buffer.data();
+        for (auto history : { &ResHis, &ComHis, &IndHis, &CrimeHis, &PollutionHis, &MoneyHis, &MiscHis })
+        {
+            std::memcpy(history->data(), source, sizeof(GraphHistory));
+            source += sizeof(GraphHistory);
+        }
+
+        std::memcpy(Map.data(), source, sizeof(TileMap));
+    }
+
+
+    unsigned int classicWord(const unsigned char* data, const std::size_t index)
+    {
+        return (static_cast<unsigned int>(data[index * 2]) << 8) | data[index * 2 + 1];
+    }
+
+
+    int classicSignedWord(const unsigned char* data, const std::size_t index)
+    {
+        return static_cast<int16_t>(classicWord(data, index));
+    }
+
+
+    int classicLong(const unsigned char* data, const std::size_t index)
+    {
+        return static_cast<int>((classicWord(data, index) << 16) | classicWord(data, index + 1));
+    }
+
+
+    /**
+     * Widens a city from the original game. Its 32 bit values are split
+     * over two words of the misc history and the budget percentages are
+     * 16.16 fixed point, so those are put back the way loadFile() and
+     * saveFile() expect them.
+     */
+    void loadClassic(const std::vector<unsigned char>& buffer)
+    {
+        const unsigned char* data = buffer.data();
+
+        const std::array<std::pair<GraphHistory*, GraphHistory*>, 6> histories
+        { {
+            { &ResHis, &ResHis120Years },
+            { &ComHis, &ComHis120Years },
+            { &IndHis, &IndHis120Years },
+            { &CrimeHis, &CrimeHis120Years },
+            { &PollutionHis, &PollutionHis120Years },
+            { &MoneyHis, &MoneyHis120Years }
+        } };
+
+        for (std::size_t i = 0; i < histories.size(); ++i)
+        {
+            const std::size_t offset = i * ClassicHistoryWords;
+            for (std::size_t j = 0; j < HistoryLength; ++j)
+            {
+                (*histories[i].first)[j] = classicSignedWord(data, offset + j);
+                (*histories[i].second)[j] = classicSignedWord(data, offset + HistoryLength + j);
+            }
+        }
+
+        for (std::size_t i = 0; i < HistoryLength; ++i)
+        {
+            MiscHis[i] = classicSignedWord(data, ClassicMiscOffset + i);
+        }
+
+        MiscHis[8] = classicLong(data, ClassicMiscOffset + 8);
+        MiscHis[50] = classicLong(data, ClassicMiscOffset + 50);
+        MiscHis[51] = MiscHis[50];
+
+        for (const std::size_t percent : { 58, 60, 62 })
+        {
+            MiscHis[percent] = static_cast<int>((static_cast<long long>(classicLong(data, ClassicMiscOffset + percent)) * 100) / 65536);
+        }
+
+        const unsigned char* tiles = data + (ClassicMapOffset * 2);
+        for (int x = 0; x < SimWidth; ++x)
+        {
+            for (int y = 0; y < SimHeight; ++y)
+            {
+                Map[x][y] = static_cast<int>(classicWord(tiles, (x * SimHeight) + y));
+            }
+        }
+    }
+
+
+    bool loadBuffer(const std::vector<unsigned char>& buffer)
     {
-        for (size_t i = 0; i < ResHis.size(); ++i)
+        if (buffer.size() == NativeFileSize)
         {
-            graph[i] = buf[i];
+            loadNative(buffer);
+            return true;
         }
+
+        if (buffer.size() == ClassicFileSize)
+        {
+            loadClassic(buffer);
+            return true;
+        }
+
+        return false;
     }
 
+
     bool _load_file(const std::string filename)
     {
-        std::ifstream infile(filename, std::ofstream::binary);
-        if (infile.fail())
+        return loadBuffer(readFile(filename));
+    }
+
+
+    /**
+     * Scenarios as they were straight after being started, keyed by
+     * the CRC-32 of the scenario file and the scenario id, so starting
+     * one again is a single copy.
+     */
+    std::map<std::uint64_t, std::unique_ptr<SimulationClone>> PreloadedScenarios;
+
+
+    /**
+     * Starts a scenario from its preloaded copy. The random generator,
+     * frame count and the player's settings stay as they are, the same
+     * as they would starting it from the file.
+     */
+    void startPreloaded(SimulationClone& scenario, CityProperties& properties, Budget& budget)
+    {
+        scenario.random = RandomState();
+        scenario.frame = simulationFrame();
+
+        scenario.autoBudget = autoBudget();
+        scenario.autoBulldoze = AutoBulldoze;
+        scenario.noDisasters = NoDisasters;
+
+        restoreSimulation(scenario, properties, budget);
+    }
+
+
+    /**
+     * A tax rate read from a file. Several of the shipped cities have
+     * nonsense here, which gets the original game's default instead.
+     */
+    int loadedTaxRate(const int rate)
+    {
+        return (rate >= Budget::MinTaxRate && rate <= Budget::MaxTaxRate) ? rate : Budget::DefaultTaxRate;
+    }
+
+
+    /**
+     * A funding rate read from a file. Anything out of range, e.g. the
+     * millions of percent some of the shipped cities decode to, is
+     * taken as full funding.
+     */
+    float loadedFundingRate(const float rate)
+    {
+        return (rate >= Budget::MinFundingRate && rate <= Budget::MaxFundingRate) ? rate : Budget::MaxFundingRate;
+    }
+
+
+    /**
+     * Older files keep the budget and settings in the misc history.
+     */
+    void loadMiscSettings(Budget& budget)
+    {
+        CityTime = std::clamp(MiscHis[8], 0, std::numeric_limits<int>::max());
+        budget.CurrentFunds(MiscHis[50]);
+        budget.PreviousFunds(MiscHis[51]);
+        AutoBulldoze = MiscHis[52];
+        autoBudget(MiscHis[53]);
+        autoGoto(MiscHis[54]);
+
+        userSoundOn(MiscHis[55]);
+        budget.TaxRate(loadedTaxRate(MiscHis[56]));
+        SimSpeed(static_cast<SimulationSpeed>(MiscHis[57]));
+
+        budget.PolicePercent(loadedFundingRate(MiscHis[58] / 100.0f));
+        budget.FirePercent(loadedFundingRate(MiscHis[60] / 100.0f));
+        budget.RoadPercent(loadedFundingRate(MiscHis[62] / 100.0f));
+    }
+
+
+    constexpr CityFile::Tag TilesChunk{ 'T', 'I', 'L', 'E' };
+    constexpr CityFile::Tag HistoriesChunk{ 'H', 'I', 'S', 'T' };
+    constexpr CityFile::Tag MiscChunk{ 'M', 'I', 'S', 'C' };
+    constexpr CityFile::Tag BudgetChunk{ 'B', 'U', 'D', 'G' };
+    constexpr CityFile::Tag SettingsChunk{ 'S', 'E', 'T', 'T' };
+    constexpr CityFile::Tag DeltaChunk{ 'D', 'E', 'L', 'T' };
+    constexpr CityFile::Tag SimulationChunk{ 'S', 'I', 'M', 'S' };
+
+    constexpr int DeltaBlockSize{ 8 };
+
+    const std::array<GraphHistory*, 12> SavedHistories
+    {
+        &ResHis, &ResHis120Years,
+        &ComHis, &ComHis120Years,
+        &IndHis, &IndHis120Years,
+        &CrimeHis, &CrimeHis120Years,
+        &PollutionHis, &PollutionHis120Years,
+        &MoneyHis, &MoneyHis120Years
+    };
+
+
+    std::uint32_t floatBits(const float value)
+    {
+        std::uint32_t bits{};
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+
+    float bitsFloat(const std::uint32_t bits)
+    {
+        float value{};
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+
+    void putHistory(CityFile::ChunkData& data, const GraphHistory& history)
+    {
+        for (const auto value : history)
         {
-            infile.close();
-            return false;
+            data.put32(static_cast<std::uint32_t>(value));
+        }
+    }
+
+
+    void getHistory(CityFile::ChunkData& data, GraphHistory& history)
+    {
+        for (auto& value : history)
+        {
+            value = static_cast<int>(data.get32());
+        }
+    }
+
+
+    void putBudget(CityFile::ChunkData& data, const SavedCity& city)
+    {
+        data.put32(static_cast<std::uint32_t>(city.currentFunds));
+        data.put32(static_cast<std::uint32_t>(city.previousFunds));
+        data.put32(static_cast<std::uint32_t>(city.taxRate));
+        data.put32(floatBits(city.policePercent));
+        data.put32(floatBits(city.firePercent));
+        data.put32(floatBits(city.roadPercent));
+    }
+
+
+    void getBudget(CityFile::ChunkData& data, SavedCity& city)
+    {
+        city.currentFunds = static_cast<int>(data.get32());
+        city.previousFunds = static_cast<int>(data.get32());
+        city.taxRate = static_cast<int>(data.get32());
+        city.policePercent = bitsFloat(data.get32());
+        city.firePercent = bitsFloat(data.get32());
+        city.roadPercent = bitsFloat(data.get32());
+    }
+
+
+    void putSettings(CityFile::ChunkData& data, const SavedCity& city)
+    {
+        data.put32(static_cast<std::uint32_t>(city.cityTime));
+        data.put16(static_cast<std::uint16_t>(city.autoBulldoze));
+        data.put16(static_cast<std::uint16_t>(city.autoBudget));
+        data.put16(static_cast<std::uint16_t>(city.autoGoto));
+        data.put16(static_cast<std::uint16_t>(city.sound));
+        data.put16(static_cast<std::uint16_t>(city.speed));
+        data.putString(city.cityName);
+    }
+
+
+    void getSettings(CityFile::ChunkData& data, SavedCity& city)
+    {
+        city.cityTime = static_cast<int>(data.get32());
+        city.autoBulldoze = data.get16() != 0;
+        city.autoBudget = data.get16() != 0;
+        city.autoGoto = data.get16() != 0;
+        city.sound = data.get16() != 0;
+        city.speed = data.get16();
+        city.cityName = data.getString();
+    }
+
+
+    void putPoint(CityFile::ChunkData& data, const Point<int>& point)
+    {
+        data.put32(static_cast<std::uint32_t>(point.x));
+        data.put32(static_cast<std::uint32_t>(point.y));
+    }
+
+
+    Point<int> getPoint(CityFile::ChunkData& data)
+    {
+        const int x = static_cast<int>(data.get32());
+        return { x, static_cast<int>(data.get32()) };
+    }
+
+
+    /**
+     * Stores \c values as 16 bit words when they all fit, which most
+     * derived state does, so runs of them compress well.
+     */
+    void putValues(CityFile::ChunkData& data, const std::vector<int>& values)
+    {
+        const bool wide = std::any_of(values.begin(), values.end(), [](const int value)
+        {
+            return (value < std::numeric_limits<std::int16_t>::min()) || (value > std::numeric_limits<std::int16_t>::max());
+        });
+
+        data.put32(static_cast<std::uint32_t>(values.size()));
+        data.put16(wide ? 1 : 0);
+
+        for (const auto value : values)
+        {
+            if (wide)
+            {
+                data.put32(static_cast<std::uint32_t>(value));
+            }
+            else
+            {
+                data.put16(static_cast<std::uint16_t>(value));
+            }
+        }
+    }
+
+
+    std::vector<int> getValues(CityFile::ChunkData& data, const std::size_t expectedCount)
+    {
+        const std::size_t count = data.get32();
+        const bool wide = data.get16() != 0;
+        if (count != expectedCount)
+        {
+            throw std::runtime_error("getValues(): Unexpected number of values.");
+        }
+
+        std::vector<int> values(count);
+        for (auto& value : values)
+        {
+            value = wide ? static_cast<int>(data.get32()) : static_cast<std::int16_t>(data.get16());
+        }
+
+        return values;
+    }
+
+
+    /**
+     * The zone registry is stored a field at a time, the same way it's
+     * kept in memory.
+     */
+    void putZones(CityFile::ChunkData& data, const ZoneRegistry& zones)
+    {
+        std::vector<int> x, y, type, population, powered, census;
+        for (std::size_t zone = 0; zone < zones.size(); ++zone)
+        {
+            x.push_back(zones.location(zone).x);
+            y.push_back(zones.location(zone).y);
+            type.push_back(zones.type(zone));
+            population.push_back(zones.population(zone));
+            powered.push_back(zones.powered(zone) ? 1 : 0);
+            census.insert(census.end(), zones.census(zone).begin(), zones.census(zone).end());
+        }
+
+        data.put32(static_cast<std::uint32_t>(zones.size()));
+        for (const auto* values : { &x, &y, &type, &population, &powered, &census })
+        {
+            putValues(data, *values);
+        }
+    }
+
+
+    ZoneRegistry getZones(CityFile::ChunkData& data)
+    {
+        const std::size_t count = data.get32();
+        const auto x = getValues(data, count);
+        const auto y = getValues(data, count);
+        const auto type = getValues(data, count);
+        const auto population = getValues(data, count);
+        const auto powered = getValues(data, count);
+        const auto census = getValues(data, count * CensusCounterCount);
+
+        ZoneRegistry zones;
+        for (std::size_t zone = 0; zone < count; ++zone)
+        {
+            const Point<int> location{ x[zone], y[zone] };
+            if (!CoordinatesValid(location))
+            {
+                throw std::runtime_error("getZones(): Zone is off the map.");
+            }
+
+            // The registry is sorted by column then row
+            if ((zone > 0) && ((x[zone - 1] > location.x) || ((x[zone - 1] == location.x) && (y[zone - 1] >= location.y))))
+            {
+                throw std::runtime_error("getZones(): Zones are out of order.");
+            }
+
+            zones.add(location, type[zone]);
+            zones.update(zone, type[zone], population[zone], powered[zone] != 0);
+            std::copy_n(census.begin() + (zone * CensusCounterCount), CensusCounterCount, zones.census(zone).begin());
+        }
+
+        return zones;
+    }
+
+
+    void putSimulation(CityFile::ChunkData& data, const SimulationState& state)
+    {
+        putValues(data, { state.scycle, state.fcycle, state.rValve, state.cValve, state.iValve });
+
+        putZones(data, state.zones);
+
+        std::vector<int> columnCensus;
+        for (const auto& column : state.columnCensus)
+        {
+            columnCensus.insert(columnCensus.end(), column.begin(), column.end());
+        }
+        putValues(data, columnCensus);
+
+        putValues(data, std::vector<int>(state.powerMap.begin(), state.powerMap.end()));
+
+        data.put32(static_cast<std::uint32_t>(state.powerStack.size()));
+        for (const auto& location : state.powerStack)
+        {
+            putPoint(data, location);
+        }
+
+        putPoint(data, state.cityCenter);
+        putPoint(data, state.pollutionMax);
+
+        data.put32(static_cast<std::uint32_t>(state.effectMaps.size()));
+        for (const auto& map : state.effectMaps)
+        {
+            const auto size = map.dimensions();
+            data.put16(static_cast<std::uint16_t>(size.x));
+            data.put16(static_cast<std::uint16_t>(size.y));
+
+            std::vector<int> values;
+            for (int y{}; y < size.y; ++y)
+            {
+                for (int x{}; x < size.x; ++x)
+                {
+                    values.push_back(map.value({ x, y }));
+                }
+            }
+            putValues(data, values);
+        }
+    }
+
+
+    void getSimulation(CityFile::ChunkData& data, SimulationState& state)
+    {
+        const auto cycles = getValues(data, 5);
+        state.scycle = cycles[0];
+        state.fcycle = cycles[1];
+        state.rValve = cycles[2];
+        state.cValve = cycles[3];
+        state.iValve = cycles[4];
+
+        state.zones = getZones(data);
+
+        const auto columnCensus = getValues(data, SimWidth * CensusCounterCount);
+        for (std::size_t x = 0; x < state.columnCensus.size(); ++x)
+        {
+            std::copy_n(columnCensus.begin() + (x * CensusCounterCount), CensusCounterCount, state.columnCensus[x].begin());
         }
 
-        int buff[HistoryLength]{};
+        const auto powerMap = getValues(data, state.powerMap.size());
+        std::copy(powerMap.begin(), powerMap.end(), state.powerMap.begin());
+
+        state.powerStack.resize(data.get32());
+        for (auto& location : state.powerStack)
+        {
+            location = getPoint(data);
+        }
+
+        state.cityCenter = getPoint(data);
+        state.pollutionMax = getPoint(data);
+
+        state.effectMaps.clear();
+        const std::size_t mapCount = data.get32();
+        for (std::size_t i = 0; i < mapCount; ++i)
+        {
+            const int width = data.get16();
+            const int height = data.get16();
+            const auto values = getValues(data, static_cast<std::size_t>(width * height));
+
+            EffectMap map({ width, height });
+            for (int y{}; y < height; ++y)
+            {
+                for (int x{}; x < width; ++x)
+                {
+                    map.value({ x, y }) = values[(y * width) + x];
+                }
+            }
+            state.effectMaps.push_back(std::move(map));
+        }
+    }
+
 
-        infile.read(reinterpret_cast<char*>(&buff[0]), sizeof(GraphHistory));
-        copyBufIntoArray(buff, ResHis);
+    bool blockChanged(const TileMap& base, const TileMap& map, const Point<int>& begin, const Point<int>& end)
+    {
+        for (int x = begin.x; x < end.x; ++x)
+        {
+            if (!std::equal(map[x].begin() + begin.y, map[x].begin() + end.y, base[x].begin() + begin.y))
+            {
+                return true;
+            }
+        }
 
-        infile.read(reinterpret_cast<char*>(&buff[0]), sizeof(GraphHistory));
-        copyBufIntoArray(buff, ComHis);
+        return false;
+    }
 
-        infile.read(reinterpret_cast<char*>(&buff[0]), sizeof(GraphHistory));
-        copyBufIntoArray(buff, IndHis);
 
-        infile.read(reinterpret_cast<char*>(&buff[0]), sizeof(GraphHistory));
-        copyBufIntoArray(buff, CrimeHis);
+    /**
+     * A delta holds every block of the map that differs from the last
+     * full save followed by the rest of the city, so only the newest
+     * delta in a file needs to be applied.
+     */
+    void putDelta(CityFile::ChunkData& data, const TileMap& base, const SavedCity& city)
+    {
+        std::vector<Point<int>> changedBlocks;
+        forEachBlock(DeltaBlockSize, [&](const Point<int>& begin, const Point<int>& end)
+        {
+            if (blockChanged(base, city.map, begin, end))
+            {
+                changedBlocks.push_back(begin);
+            }
+        });
+
+        data.put16(static_cast<std::uint16_t>(changedBlocks.size()));
+        for (const auto& begin : changedBlocks)
+        {
+            data.put16(static_cast<std::uint16_t>(begin.x));
+            data.put16(static_cast<std::uint16_t>(begin.y));
+
+            for (int x = begin.x; x < std::min(begin.x + DeltaBlockSize, SimWidth); ++x)
+            {
+                for (int y = begin.y; y < std::min(begin.y + DeltaBlockSize, SimHeight); ++y)
+                {
+                    data.put16(static_cast<std::uint16_t>(city.map[x][y]));
+                }
+            }
+        }
+
+        for (const auto& history : city.histories)
+        {
+            putHistory(data, history);
+        }
+        putHistory(data, city.misc);
+        putBudget(data, city);
+        putSettings(data, city);
+    }
+
+
+    void getDelta(CityFile::ChunkData& data, SavedCity& city)
+    {
+        const int blockCount = data.get16();
+        for (int i = 0; i < blockCount; ++i)
+        {
+            const int beginX = data.get16();
+            const int beginY = data.get16();
+            if (beginX >= SimWidth || beginY >= SimHeight)
+            {
+                throw std::runtime_error("getDelta(): Map block is out of range.");
+            }
+
+            for (int x = beginX; x < std::min(beginX + DeltaBlockSize, SimWidth); ++x)
+            {
+                for (int y = beginY; y < std::min(beginY + DeltaBlockSize, SimHeight); ++y)
+                {
+                    city.map[x][y] = data.get16();
+                }
+            }
+        }
+
+        for (auto& history : city.histories)
+        {
+            getHistory(data, history);
+        }
+        getHistory(data, city.misc);
+        getBudget(data, city);
+        getSettings(data, city);
+    }
+
+
+    void applyCity(const SavedCity& city, CityProperties& properties, Budget& budget)
+    {
+        Map = city.map;
+        for (std::size_t i = 0; i < SavedHistories.size(); ++i)
+        {
+            *SavedHistories[i] = city.histories[i];
+        }
+        MiscHis = city.misc;
 
-        infile.read(reinterpret_cast<char*>(&buff[0]), sizeof(GraphHistory));
-        copyBufIntoArray(buff, PollutionHis);
+        budget.CurrentFunds(city.currentFunds);
+        budget.PreviousFunds(city.previousFunds);
+        budget.TaxRate(loadedTaxRate(city.taxRate));
+        budget.PolicePercent(loadedFundingRate(city.policePercent));
+        budget.FirePercent(loadedFundingRate(city.firePercent));
+        budget.RoadPercent(loadedFundingRate(city.roadPercent));
 
-        infile.read(reinterpret_cast<char*>(&buff[0]), sizeof(GraphHistory));
-        copyBufIntoArray(buff, MoneyHis);
+        CityTime = std::max(city.cityTime, 0);
+        AutoBulldoze = city.autoBulldoze;
+        autoBudget(city.autoBudget);
+        autoGoto(city.autoGoto);
+        userSoundOn(city.sound);
+        SimSpeed(static_cast<SimulationSpeed>(city.speed));
+        properties.CityName(city.cityName);
+    }
 
-        infile.read(reinterpret_cast<char*>(&buff[0]), sizeof(GraphHistory));
-        copyBufIntoArray(buff, MiscHis);
 
-        int mapRow[SimHeight]{};
-        for (size_t row = 0; row < SimWidth; ++row)
+    /**
+     * Reads every chunk into \c city, which is only applied once all
+     * of them have checked out. Unknown chunks are skipped.
+     *
+     * Deltas are appended to a complete save, so once the full save
+     * has been read a damaged chunk is taken to be a delta that was
+     * cut short and everything from there on is ignored.
+     *
+     * The simulation state belongs to the full save, it's only used
+     * if no delta was appended since.
+     */
+    bool loadCityFile(std::istream& stream, SavedCity& city)
+    {
+        try
         {
-            infile.read(reinterpret_cast<char*>(&mapRow[0]), sizeof(mapRow));
+            CityFile::Reader reader(stream);
+            if (reader.header().width != SimWidth || reader.header().height != SimHeight)
+            {
+                return false;
+            }
+
+            city.seed = reader.header().seed;
+
+            std::map<CityFile::Tag, CityFile::ChunkData> chunks;
+
+            CityFile::Tag tag{};
+            CityFile::ChunkData data;
+            while (true)
+            {
+                try
+                {
+                    if (!reader.next(tag, data))
+                    {
+                        break;
+                    }
+                }
+                catch (const std::runtime_error&)
+                {
+                    if (chunks.count(TilesChunk) && chunks.count(BudgetChunk) && chunks.count(SettingsChunk))
+                    {
+                        break;
+                    }
+                    throw;
+                }
+
+                chunks[tag] = std::move(data);
+            }
+
+            if (!chunks.count(TilesChunk) || !chunks.count(BudgetChunk) || !chunks.count(SettingsChunk))
+            {
+                return false;
+            }
 
-            for (size_t i = 0; i < SimHeight; ++i)
+            for (auto& column : city.map)
             {
-                Map[row][i] = mapRow[i];
+                for (auto& tile : column)
+                {
+                    tile = chunks[TilesChunk].get16();
+                }
             }
+
+            if (chunks.count(HistoriesChunk))
+            {
+                for (auto& history : city.histories)
+                {
+                    getHistory(chunks[HistoriesChunk], history);
+                }
+            }
+
+            if (chunks.count(MiscChunk))
+            {
+                getHistory(chunks[MiscChunk], city.misc);
+            }
+
+            getBudget(chunks[BudgetChunk], city);
+            getSettings(chunks[SettingsChunk], city);
+
+            city.warmStart = false;
+            if (chunks.count(DeltaChunk))
+            {
+                getDelta(chunks[DeltaChunk], city);
+            }
+            else if (chunks.count(SimulationChunk))
+            {
+                getSimulation(chunks[SimulationChunk], city.simulation);
+                city.warmStart = simulationStateFits(city.simulation);
+            }
+        }
+        catch (const std::runtime_error& error)
+        {
+            std::cout << error.what() << std::endl;
+            return false;
         }
-           
-        infile.close();
 
         return true;
     }
+
+
+    /**
+     * Restarts the simulation on a freshly loaded map, from \c state
+     * if there is one or by scanning the map otherwise.
+     */
+    void startSimulation(const SimulationState* state, CityProperties& properties, Budget& budget)
+    {
+        initWillStuff();
+        ScenarioID = 0;
+
+        if (state)
+        {
+            DoSimInit(properties, *state);
+        }
+        else
+        {
+            DoSimInit(properties, budget);
+        }
+    }
+
+
+    /**
+     * Visits every map tile and history value of \c city in a fixed order.
+     */
+    template <typename City, typename Function>
+    void forEachValue(City& city, Function function)
+    {
+        for (auto& column : city.map)
+        {
+            for (auto& tile : column)
+            {
+                function(tile);
+            }
+        }
+
+        for (auto& history : city.histories)
+        {
+            for (auto& value : history)
+            {
+                function(value);
+            }
+        }
+
+        for (auto& value : city.misc)
+        {
+            function(value);
+        }
+    }
+
+
+    constexpr std::size_t CityValueCount{ SimWidth * SimHeight + (std::tuple_size<decltype(SavedCity::histories)>::value + 1) * HistoryLength };
 }
 
 
 bool loadFile(const std::string& filename, CityProperties& properties, Budget& budget)
 {
-    if (!_load_file(filename))
+    std::ifstream infile(filename, std::ifstream::binary);
+    if (infile.fail())
     {
         return false;
     }
 
-    CityTime = std::clamp(MiscHis[8], 0, std::numeric_limits<int>::max());
-    budget.CurrentFunds(MiscHis[50]);
-    budget.PreviousFunds(MiscHis[51]);
-    AutoBulldoze = MiscHis[52];
-    autoBudget(MiscHis[53]);
-    autoGoto(MiscHis[54]);
+    if (CityFile::isCityFile(infile))
+    {
+        auto city = std::make_unique<SavedCity>();
+        if (!loadCityFile(infile, *city))
+        {
+            return false;
+        }
 
-    userSoundOn(MiscHis[55]);
-    budget.TaxRate(std::clamp(MiscHis[56], 0, 20));
-    SimSpeed(static_cast<SimulationSpeed>(MiscHis[57]));
+        restoreCity(*city, properties, budget);
+        return true;
+    }
 
-    budget.PolicePercent(static_cast<float>(MiscHis[58] / 100.0f));
-    budget.FirePercent(static_cast<float>(MiscHis[60] / 100.0f));
-    budget.RoadPercent(static_cast<float>(MiscHis[62] / 100.0f));
+    infile.close();
+    if (!_load_file(filename))
+    {
+        return false;
+    }
 
-    initWillStuff();
-    ScenarioID = 0;
-    DoSimInit(properties, budget);
+    loadMiscSettings(budget);
+    startSimulation(nullptr, properties, budget);
 
     return true;
 }
 
 
-bool saveFile(const std::string& filename, const CityProperties&, const Budget& budget)
+/**
+ * Makes \c city the running city and restarts the simulation on it.
+ */
+void restoreCity(const SavedCity& city, CityProperties& properties, Budget& budget)
 {
-    std::ofstream outfile(filename, std::ofstream::binary);
-    if (outfile.fail())
+    applyCity(city, properties, budget);
+    startSimulation(city.warmStart ? &city.simulation : nullptr, properties, budget);
+}
+
+
+/**
+ * Encodes how \c city differs from \c previous, an earlier capture
+ * of the same city, or all of it if there's no \c previous. Every
+ * map tile and history value is XOR'd with its earlier self and run
+ * length compressed, so whatever didn't change costs next to nothing.
+ * The low words of the values go first and the high words, which
+ * are nearly all zero, after them. The simulation state isn't kept.
+ */
+CityChange encodeCityChange(const SavedCity* previous, const SavedCity& city)
+{
+    std::vector<std::uint32_t> changes;
+    changes.reserve(CityValueCount);
+    forEachValue(city, [&](const int value) { changes.push_back(static_cast<std::uint32_t>(value)); });
+
+    if (previous)
     {
-        outfile.close();
-        return false;
+        std::size_t index = 0;
+        forEachValue(*previous, [&](const int value) { changes[index++] ^= static_cast<std::uint32_t>(value); });
     }
 
-    MiscHis[8] = CityTime;
-    MiscHis[50] = budget.CurrentFunds();
-    MiscHis[51] = budget.PreviousFunds();
+    std::vector<std::uint16_t> words(changes.size() * 2);
+    for (std::size_t i = 0; i < changes.size(); ++i)
+    {
+        words[i] = static_cast<std::uint16_t>(changes[i] & 0xffff);
+        words[changes.size() + i] = static_cast<std::uint16_t>(changes[i] >> 16);
+    }
 
-    MiscHis[52] = AutoBulldoze;
-    MiscHis[53] = autoBudget(); 
-    MiscHis[54] = autoGoto();
-    MiscHis[55] = userSoundOn();
-    MiscHis[57] = static_cast<int>(SimSpeed());
-    MiscHis[56] = budget.TaxRate();
+    CityFile::ChunkData settings;
+    putBudget(settings, city);
+    putSettings(settings, city);
 
-    MiscHis[58] = static_cast<int>(budget.PolicePercent() * 100.0f);
-    MiscHis[60] = static_cast<int>(budget.FirePercent() * 100.0f);
-    MiscHis[62] = static_cast<int>(budget.RoadPercent() * 100.0f);
+    return { previous == nullptr, CityFile::compressWordRuns(words), settings.bytes() };
+}
 
-    outfile.write(reinterpret_cast<char*>(ResHis.data()), sizeof(GraphHistory));
-    outfile.write(reinterpret_cast<char*>(ComHis.data()), sizeof(GraphHistory));
-    outfile.write(reinterpret_cast<char*>(IndHis.data()), sizeof(GraphHistory));
-    outfile.write(reinterpret_cast<char*>(CrimeHis.data()), sizeof(GraphHistory));
-    outfile.write(reinterpret_cast<char*>(PollutionHis.data()), sizeof(GraphHistory));
-    outfile.write(reinterpret_cast<char*>(MoneyHis.data()), sizeof(GraphHistory));
-    outfile.write(reinterpret_cast<char*>(MiscHis.data()), sizeof(GraphHistory));
-    outfile.write(reinterpret_cast<char*>(Map.data()), sizeof(Map));
 
-    outfile.close();
-    return true;
+/**
+ * Turns \c city, holding the capture \c change was encoded against,
+ * into the capture it was encoded from.
+ */
+void applyCityChange(const CityChange& change, SavedCity& city)
+{
+    CityFile::ChunkData values(CityFile::expandWordRuns(change.values, CityValueCount * 4));
+    if (values.bytes().size() != CityValueCount * 4)
+    {
+        throw std::runtime_error("applyCityChange(): Change is damaged.");
+    }
+
+    std::vector<std::uint32_t> changes(CityValueCount);
+    for (auto& change : changes)
+    {
+        change = values.get16();
+    }
+    for (auto& change : changes)
+    {
+        change |= static_cast<std::uint32_t>(values.get16()) << 16;
+    }
+
+    std::size_t index = 0;
+    forEachValue(city, [&](int& value)
+    {
+        const int stored = static_cast<int>(changes[index++]);
+        value = change.complete ? stored : value ^ stored;
+    });
+
+    CityFile::ChunkData settings(change.settings);
+    getBudget(settings, city);
+    getSettings(settings, city);
+
+    city.warmStart = false;
+}
+
+
+/**
+ * Copies everything a save needs so it can be written while the
+ * simulation carries on.
+ */
+void captureCity(SavedCity& city, const CityProperties& properties, const Budget& budget)
+{
+    city.map = Map;
+
+    for (std::size_t i = 0; i < SavedHistories.size(); ++i)
+    {
+        city.histories[i] = *SavedHistories[i];
+    }
+    city.misc = MiscHis;
+
+    city.currentFunds = budget.CurrentFunds();
+    city.previousFunds = budget.PreviousFunds();
+    city.taxRate = budget.TaxRate();
+    city.policePercent = budget.PolicePercent();
+    city.firePercent = budget.FirePercent();
+    city.roadPercent = budget.RoadPercent();
+
+    city.cityTime = CityTime;
+    city.autoBulldoze = AutoBulldoze;
+    city.autoBudget = autoBudget();
+    city.autoGoto = autoGoto();
+    city.sound = userSoundOn();
+    city.speed = static_cast<int>(SimSpeed());
+    city.cityName = properties.CityName();
+    city.seed = static_cast<std::uint32_t>(RandomSeed());
+
+    city.warmStart = captureSimulationState(city.simulation);
+}
+
+
+/**
+ * Writes \c city next to \c filename and renames it into place once
+ * complete so an interrupted save never leaves a truncated city.
+ */
+bool writeCity(const std::string& filename, const SavedCity& city)
+{
+    const std::string tempFilename = filename + ".tmp";
+
+    {
+        std::ofstream outfile(tempFilename, std::ofstream::binary);
+        if (outfile.fail())
+        {
+            return false;
+        }
+
+        CityFile::Writer writer(outfile, { CityFile::Version, SimWidth, SimHeight, city.seed });
+
+        CityFile::ChunkData tiles;
+        for (const auto& column : city.map)
+        {
+            for (const auto tile : column)
+            {
+                tiles.put16(static_cast<std::uint16_t>(tile));
+            }
+        }
+        writer.chunk(TilesChunk, tiles, CityFile::Compression::WordRuns);
+
+        CityFile::ChunkData histories;
+        for (const auto& history : city.histories)
+        {
+            putHistory(histories, history);
+        }
+        writer.chunk(HistoriesChunk, histories, CityFile::Compression::WordRuns);
+
+        CityFile::ChunkData misc;
+        putHistory(misc, city.misc);
+        writer.chunk(MiscChunk, misc, CityFile::Compression::WordRuns);
+
+        CityFile::ChunkData funds;
+        putBudget(funds, city);
+        writer.chunk(BudgetChunk, funds, CityFile::Compression::None);
+
+        CityFile::ChunkData settings;
+        putSettings(settings, city);
+        writer.chunk(SettingsChunk, settings, CityFile::Compression::None);
+
+        if (city.warmStart)
+        {
+            CityFile::ChunkData simulation;
+            putSimulation(simulation, city.simulation);
+            writer.chunk(SimulationChunk, simulation, CityFile::Compression::WordRuns);
+        }
+
+        outfile.flush();
+        if (!outfile.good())
+        {
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempFilename, filename, error);
+    return !error;
+}
+
+
+/**
+ * Appends the blocks of \c city that differ from \c base, plus its
+ * histories, budget and settings, to a file last written in full by
+ * \c writeCity() with \c base as its map.
+ */
+bool appendCityDelta(const std::string& filename, const TileMap& base, const SavedCity& city)
+{
+    std::ofstream outfile(filename, std::ofstream::binary | std::ofstream::app);
+    if (outfile.fail())
+    {
+        return false;
+    }
+
+    CityFile::ChunkData delta;
+    putDelta(delta, base, city);
+
+    CityFile::Writer writer(outfile);
+    writer.chunk(DeltaChunk, delta, CityFile::Compression::WordRuns);
+
+    outfile.flush();
+    return outfile.good();
 }
 
 
@@ -194,7 +1107,10 @@ bool LoadCity(const std::string& filename, CityProperties& properties, Budget& b
 
 void SaveCity(const std::string& filename, const CityProperties& properties, const Budget& budget)
 {
-    if (saveFile(filename, properties, budget))
+    auto city = std::make_unique<SavedCity>();
+    captureCity(*city, properties, budget);
+
+    if (writeCity(filename, *city))
     {
         std::cout << "City saved as '" << filename << "'" << std::endl;
     }
@@ -211,12 +1127,22 @@ void LoadScenario(Scenario scenario, CityProperties& properties, Budget& budget)
 
     const auto& scenarioProperties = ScenarioPropertiesTable.at(scenario);
 
+    const auto buffer = readFile("scenarios/" + scenarioProperties.FileName);
+    const std::uint64_t key = (static_cast<std::uint64_t>(CityFile::crc32(buffer)) << 32) | static_cast<std::uint32_t>(scenarioProperties.Id);
+
+    const auto preloaded = PreloadedScenarios.find(key);
+    if (preloaded != PreloadedScenarios.end())
+    {
+        startPreloaded(*preloaded->second, properties, budget);
+        return;
+    }
+
     properties.CityName(scenarioProperties.CityName);
     budget.CurrentFunds(scenarioProperties.StartingFunds);
     CityTime = scenarioProperties.Time;
     ScenarioID = scenarioProperties.Id;
 
-    _load_file("scenarios/" + scenarioProperties.FileName);
+    const bool loaded = loadBuffer(buffer);
 
     SimSpeed(SimulationSpeed::Normal);
 
@@ -225,4 +1151,10 @@ void LoadScenario(Scenario scenario, CityProperties& properties, Budget& budget)
     InitSimLoad = 1;
     DoInitialEval = 0;
     DoSimInit(properties, budget);
+
+    auto started = std::make_unique<SimulationClone>();
+    if (loaded && cloneSimulation(*started, properties, budget))
+    {
+        PreloadedScenarios[key] = std::move(started);
+    }
 }
@@ -10,7 +10,14 @@
 // file, included in this distribution, for details.
 #pragma once
 
+#include "Map.h"
+#include "s_alloc.h"
+#include "s_sim.h"
+
+#include <array>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 enum class Scenario
 {
@@ -27,6 +34,55 @@ enum class Scenario
 class Budget;
 class CityProperties;
 
+
+/**
+ * Copy of the state a save writes, taken at a tick boundary.
+ */
+struct SavedCity
+{
+    TileMap map{};
+    std::array<GraphHistory, 12> histories{};
+    GraphHistory misc{};
+
+    int currentFunds{};
+    int previousFunds{};
+    int taxRate{};
+    float policePercent{};
+    float firePercent{};
+    float roadPercent{};
+
+    int cityTime{};
+    bool autoBulldoze{};
+    bool autoBudget{};
+    bool autoGoto{};
+    bool sound{};
+    int speed{};
+    std::string cityName{};
+    std::uint32_t seed{}; // the generator's seed, see RandomSeed()
+
+    bool warmStart{}; // simulation holds a SimulationState
+    SimulationState simulation{};
+};
+
+/**
+ * Difference between two captures of a city, or a whole capture.
+ */
+struct CityChange
+{
+    bool complete{}; // holds the whole city rather than a difference
+    std::vector<std::uint8_t> values; // map tiles and histories
+    std::vector<std::uint8_t> settings; // budget and settings
+};
+
+void captureCity(SavedCity&, const CityProperties&, const Budget&);
+void restoreCity(const SavedCity&, CityProperties&, Budget&);
+
+CityChange encodeCityChange(const SavedCity* previous, const SavedCity&);
+void applyCityChange(const CityChange&, SavedCity&);
+
+bool writeCity(const std::string&, const SavedCity&);
+bool appendCityDelta(const std::string&, const TileMap& base, const SavedCity&);
+
 bool LoadCity(const std::string& filename, CityProperties&, Budget&);
 void LoadScenario(Scenario, CityProperties&, Budget&);
 void SaveCity(const std::string&, const CityProperties&, const Budget&);
@@ -22,6 +22,7 @@
 
 
 #include <algorithm>
+#include <array>
 #include <limits>
 
 /* Generate Map */
@@ -44,6 +45,22 @@ int CurveLevel = -1;		/* level for river curviness */
 bool CreateIsland = false;
 
 
+namespace
+{
+    /**
+     * Neighbours looked at when smoothing edges, in the order their
+     * bits go into the edge table index.
+     */
+    constexpr std::array<Vector<int>, 4> EdgeOffsets
+    { {
+        { -1,  0 },
+        {  0,  1 },
+        {  1,  0 },
+        {  0, -1 }
+    } };
+};
+
+
 int ERand(int limit)
 {
   int x, z;
@@ -63,28 +80,22 @@ bool IsTree(int cell)
 
 void ClearMap()
 {
-    for (int x = 0; x < SimWidth; x++)
+    forEachTile([](const Point<int>& location)
     {
-        for (int y = 0; y < SimHeight; y++)
-        {
-            Map[x][y] = DIRT;
-        }
-    }
+        Map[location.x][location.y] = DIRT;
+    });
 }
 
 
 void ClearUnnatural()
 {
-    for (int x = 0; x < SimWidth; x++)
+    forEachTile([](const Point<int>& location)
     {
-        for (int y = 0; y < SimHeight; y++)
+        if (Map[location.x][location.y] > WOODS)
         {
-            if (Map[x][y] > WOODS)
-            {
-                Map[x][y] = DIRT;
-            }
+            Map[location.x][location.y] = DIRT;
         }
-    }
+    });
 }
 
 
@@ -139,9 +150,6 @@ void PutOnMap(int Mchar, int Xoff, int Yoff)
 
 void SmoothTrees()
 {
-    static int DX[4] = { -1, 0, 1, 0 };
-    static int DY[4] = { 0, 1, 0,-1 };
-
     static int TEdTab[16] =
     {
         0, 0, 0, 34,
@@ -150,54 +158,45 @@ void SmoothTrees()
         30, 31, 29, 37
     };
 
-    for (int MapX = 0; MapX < SimWidth; MapX++)
+    forEachTile([](const Point<int>& location)
     {
-        for (int MapY = 0; MapY < SimHeight; MapY++)
+        if (IsTree(Map[location.x][location.y]))
         {
-            if (IsTree(Map[MapX][MapY]))
+            int bitindex = 0;
+            forEachOffset(location, EdgeOffsets, [&bitindex](const Point<int>& neighbor, int)
             {
-                int bitindex = 0;
-                for (int z = 0; z < 4; z++)
-                {
-                    bitindex = bitindex << 1;
-
-                    int Xtem = MapX + DX[z];
-                    int Ytem = MapY + DY[z];
+                bitindex = bitindex << 1;
 
-                    if (CoordinatesValid({ Xtem, Ytem }) && IsTree(Map[Xtem][Ytem]))
-                    {
-                        bitindex++;
-                    }
+                if (CoordinatesValid(neighbor) && IsTree(Map[neighbor.x][neighbor.y]))
+                {
+                    bitindex++;
                 }
+            });
 
-                int temp = TEdTab[bitindex & 15];
+            int temp = TEdTab[bitindex & 15];
 
-                if (temp)
+            if (temp)
+            {
+                if (temp != WOODS)
                 {
-                    if (temp != WOODS)
+                    if ((location.x + location.y) & 1)
                     {
-                        if ((MapX + MapY) & 1)
-                        {
-                            temp = temp - 8;
-                        }
+                        temp = temp - 8;
                     }
-                    Map[MapX][MapY] = temp + BLBNBIT;
-                }
-                else
-                {
-                    Map[MapX][MapY] = temp;
                 }
+                Map[location.x][location.y] = temp + BLBNBIT;
+            }
+            else
+            {
+                Map[location.x][location.y] = temp;
             }
         }
-    }
+    });
 }
 
 
 void SmoothRiver()
 {
-    static int DX[4] = { -1, 0, 1, 0 };
-    static int DY[4] = { 0, 1, 0,-1 };
-
     static int REdTab[16] =
     {
         13 + BULLBIT, 13 + BULLBIT, 17 + BULLBIT, 15 + BULLBIT,
@@ -206,40 +205,34 @@ void SmoothRiver()
         7 + BULLBIT, 9 + BULLBIT, 5 + BULLBIT, 2
     };
 
-    for (int MapX = 0; MapX < SimWidth; MapX++)
+    forEachTile([](const Point<int>& location)
     {
-        for (int MapY = 0; MapY < SimHeight; MapY++)
+        if (Map[location.x][location.y] == REDGE)
         {
-            if (Map[MapX][MapY] == REDGE)
-            {
-                int bitindex = 0;
+            int bitindex = 0;
 
-                for (int z = 0; z < 4; z++)
+            forEachOffset(location, EdgeOffsets, [&bitindex](const Point<int>& neighbor, int)
+            {
+                bitindex = bitindex << 1;
+                if (CoordinatesValid(neighbor) &&
+                    ((Map[neighbor.x][neighbor.y] & LOMASK) != DIRT) &&
+                    (((Map[neighbor.x][neighbor.y] & LOMASK) < WOODS_LOW) ||
+                        ((Map[neighbor.x][neighbor.y] & LOMASK) > WOODS_HIGH)))
                 {
-                    bitindex = bitindex << 1;
-                    int Xtem = MapX + DX[z];
-                    int Ytem = MapY + DY[z];
-                    if (CoordinatesValid({ Xtem, Ytem }) &&
-                        ((Map[Xtem][Ytem] & LOMASK) != DIRT) &&
-                        (((Map[Xtem][Ytem] & LOMASK) < WOODS_LOW) ||
-                            ((Map[Xtem][Ytem] & LOMASK) > WOODS_HIGH)))
-                    {
-                        bitindex++;
-                    }
-
+                    bitindex++;
                 }
+            });
 
-                int temp = REdTab[bitindex & 15];
-
-                if ((temp != RIVER) && (RandomRange(0, 1)))
-                {
-                    temp++;
-                }
+            int temp = REdTab[bitindex & 15];
 
-                Map[MapX][MapY] = temp;
+            if ((temp != RIVER) && (RandomRange(0, 1)))
+            {
+                temp++;
             }
+
+            Map[location.x][location.y] = temp;
         }
-    }
+    });
 }
 
 
@@ -427,21 +420,15 @@ void DoRivers()
 
 void MakeNakedIsland()
 {
-    for (int x = 0; x < SimWidth; x++)
+    forEachTile([](const Point<int>& location)
     {
-        for (int y = 0; y < SimHeight; y++)
-        {
-            Map[x][y] = RIVER;
-        }
-    }
+        Map[location.x][location.y] = RIVER;
+    });
     
-    for (int x = 5; x < SimWidth - 5; x++)
+    forEachTile({ 5, 5 }, { SimWidth - 5, SimHeight - 5 }, [](const Point<int>& location)
     {
-        for (int y = 5; y < SimHeight - 5; y++)
-        {
-            Map[x][y] = DIRT;
-        }
-    }
+        Map[location.x][location.y] = DIRT;
+    });
    
     for (int x = 0; x < SimWidth - 5; x += 2)
     {
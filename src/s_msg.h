@@ -28,6 +28,9 @@ void MessageLocation(Point<int> location);
 const Point<int>& MessageLocation();
 void AutoGotoMessageLocation(bool autogo);
 bool AutoGotoMessageLocation();
+void LastMessage(const std::string& message);
 const std::string& LastMessage();
+void LastMessageTime(int tick);
+int LastMessageTime();
 void MessageDisplayTime(int time);
 int MessageDisplayTime();
@@ -11,6 +11,7 @@
 #include "s_sim.h"
 
 #include "Budget.h"
+#include "Census.h"
 #include "CityProperties.h"
 #include "Evaluation.h"
 
@@ -19,6 +20,7 @@
 
 #include "Point.h"
 #include "Power.h"
+#include "ResumablePass.h"
 
 #include "s_alloc.h"
 #include "s_disast.h"
@@ -28,13 +30,23 @@
 
 #include "Scan.h"
 #include "Sprite.h"
+#include "TaskGraph.h"
+#include "ThreadPool.h"
+#include "TileProperties.h"
+#include "TimeSlice.h"
+#include "TimingWheel.h"
 #include "Traffic.h"
 #include "Zone.h"
 
 #include <SDL2/SDL.h>
 
 #include <algorithm>
+#include <array>
 #include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
 
 
 /* Simulation */
@@ -59,35 +71,46 @@ int DoInitialEval = 0;
 int MeltX, MeltY;
 
 
-void DoFire()
+namespace
 {
-    static int DX[4] = { -1,  0,  1,  0 };
-    static int DY[4] = { 0, -1,  0,  1 };
+    /**
+     * Directions fire spreads in, in the order they're tried.
+     */
+    constexpr std::array<Vector<int>, 4> FireSpreadOffsets
+    { {
+        { -1,  0 },
+        {  0, -1 },
+        {  1,  0 },
+        {  0,  1 }
+    } };
+};
 
-    for (int z = 0; z < 4; z++)
+
+void DoFire()
+{
+    // A chance is drawn for every direction, on the map or not.
+    forEachOffset(SimulationTarget, FireSpreadOffsets, [](const Point<int>& location, int)
     {
         if (!(Rand16() & 7))
         {
-            int Xtem = SimulationTarget.x + DX[z];
-            int Ytem = SimulationTarget.y + DY[z];
-            if (CoordinatesValid({ Xtem, Ytem }))
+            if (CoordinatesValid(location))
             {
-                int c = Map[Xtem][Ytem];
+                int c = Map[location.x][location.y];
                 if (c & BURNBIT)
                 {
                     if (c & ZONEBIT)
                     {
-                        FireZone(Xtem, Ytem, c);
+                        FireZone(location.x, location.y, c);
                         if ((c & LOMASK) > IZB) //  Explode
                         {
-                            makeExplosionAt({ (Xtem * 16) + 8, (Ytem * 16) + 8 });
+                            deferSideEffect([location]() { makeExplosionAt({ (location.x * 16) + 8, (location.y * 16) + 8 }); });
                         }
                     }
-                    Map[Xtem][Ytem] = FIRE + RandomRange(0, 3) + ANIMBIT;
+                    Map[location.x][location.y] = FIRE + RandomRange(0, 3) + ANIMBIT;
                 }
             }
         }
-    }
+    });
    
     int z = FireProtectionMap.value(SimulationTarget.skewInverseBy({ 8, 8 }));
     
@@ -113,14 +136,16 @@ void DoFire()
 
 void DoAirport()
 {
+    const auto position = SimulationTarget;
+
     if (!(RandomRange(0, 5)))
     {
-        generateAirplane(SimulationTarget);
+        deferSideEffect([position]() { generateAirplane(position); });
         return;
     }
     if (!(RandomRange(0, 12)))
     {
-        generateHelicopter(SimulationTarget);
+        deferSideEffect([position]() { generateHelicopter(position); });
     }
 }
 
@@ -167,8 +192,8 @@ void DoMeltdown(const int x, const int y)
 
 void DoRail(const Point<int>& position)
 {
-    RailTotal++;
-    generateTrain(position);
+    censusTally()[Census::Rails]++;
+    deferSideEffect([position]() { generateTrain(position); });
    
     if (RoadEffect < 30) // Deteriorating  Rail
     {
@@ -197,10 +222,7 @@ void DoRail(const Point<int>& position)
 
 void DoRadTile()
 {
-    if (RandomRange(0, 4095) == 0) // Radioactive decay
-    {
-        Map[SimulationTarget.x][SimulationTarget.y] = DIRT;
-    }
+    Map[SimulationTarget.x][SimulationTarget.y] = DIRT; // Radioactive decay
 }
 
 
@@ -331,7 +353,7 @@ void DoRoad()
         HTRFBASE    // Heavy Traffic
     };
 
-    RoadTotal++;
+    censusTally()[Census::Roads]++;
 
     if (RoadEffect < 30) // Deteriorating Roads
     {
@@ -357,27 +379,17 @@ void DoRoad()
 
     if (!(CurrentTile & BURNBIT)) /* If Bridge */
     {
-        RoadTotal += 4;
+        censusTally()[Census::Roads] += 4;
         if (DoBridge())
         {
             return;
         }
     }
 
-    int trafficDensity{};
-
-    if (CurrentTileMasked < LTRFBASE)
-    {
-        trafficDensity = 0;
-    }
-    else if (CurrentTileMasked < HTRFBASE)
-    {
-        trafficDensity = 1;
-    }
-    else
+    const int trafficDensity{ tileProperties(CurrentTileMasked).traffic };
+    if (trafficDensity == 2)
     {
-        RoadTotal++;
-        trafficDensity = 2;
+        censusTally()[Census::Roads]++;
     }
 
     int Density = TrafficDensityMap.value(SimulationTarget.skewInverseBy({ 2, 2 })) / 64;  // Set Traf Density
@@ -470,31 +482,31 @@ void DoSPZone(bool powered, const CityProperties& properties)
     switch (CurrentTileMasked)
     {
     case POWERPLANT:
-        CoalPop++;
+        censusTally()[Census::CoalPlants]++;
         if (!(CityTime & 7)) /* post */
         {
             RepairZone(POWERPLANT, 4);
         }
-        pushPowerStack(SimulationTarget);
+        deferSideEffect([position = SimulationTarget]() { pushPowerStack(position); });
         CoalSmoke(SimulationTarget.x, SimulationTarget.y);
         return;
 
     case NUCLEAR:
         if (!NoDisasters && !RandomRange(0, MltdwnTab[properties.GameLevel()]))
         {
-            DoMeltdown(SimulationTarget.x, SimulationTarget.y);
+            deferSideEffect([x = SimulationTarget.x, y = SimulationTarget.y]() { DoMeltdown(x, y); });
             return;
         }
-        NuclearPop++;
+        censusTally()[Census::NuclearPlants]++;
         if (!(CityTime & 7)) /* post */
         {
             RepairZone(NUCLEAR, 4);
         }
-        pushPowerStack(SimulationTarget);
+        deferSideEffect([position = SimulationTarget]() { pushPowerStack(position); });
         return;
 
     case FIRESTATION:
-        FireStPop++;
+        censusTally()[Census::FireStations]++;
         if (!(CityTime & 7)) /* post */
         {
             RepairZone(FIRESTATION, 3);
@@ -521,7 +533,7 @@ void DoSPZone(bool powered, const CityProperties& properties)
         return;
 
     case POLICESTATION:
-        PolicePop++;
+        censusTally()[Census::PoliceStations]++;
         if (!(CityTime & 7))
         {
             RepairZone(POLICESTATION, 3); /* post */
@@ -548,7 +560,7 @@ void DoSPZone(bool powered, const CityProperties& properties)
         return;
 
     case STADIUM:
-        StadiumPop++;
+        censusTally()[Census::Stadiums]++;
         if (!(CityTime & 15))
         {
             RepairZone(STADIUM, 4);
@@ -565,7 +577,7 @@ void DoSPZone(bool powered, const CityProperties& properties)
         return;
 
     case FULLSTADIUM:
-        StadiumPop++;
+        censusTally()[Census::Stadiums]++;
         if (!((CityTime + SimulationTarget.x + SimulationTarget.y) & 7))	/* post release */
         {
             DrawStadium(STADIUM);
@@ -573,7 +585,7 @@ void DoSPZone(bool powered, const CityProperties& properties)
         return;
 
     case AIRPORT:
-        APortPop++;
+        censusTally()[Census::Airports]++;
         
         if (!(CityTime & 7))
         {
@@ -599,92 +611,712 @@ void DoSPZone(bool powered, const CityProperties& properties)
         return;
 
     case PORT:
-        PortPop++;
+        censusTally()[Census::Seaports]++;
         if ((CityTime & 15) == 0)
         {
             RepairZone(PORT, 4);
         }
 
-        SimSprite* shipSprite = getSprite(SimSprite::Type::Ship);
-        if ((powered && shipSprite == nullptr) || (shipSprite != nullptr && !shipSprite->active))
+        deferSideEffect([powered]()
         {
-            generateShip();
-        }
+            SimSprite* shipSprite = getSprite(SimSprite::Type::Ship);
+            if ((powered && shipSprite == nullptr) || (shipSprite != nullptr && !shipSprite->active))
+            {
+                generateShip();
+            }
+        });
         return;
     }
 }
 
 
+namespace
+{
+    TimingWheel ActiveTiles;
+    ActiveTileMap ActiveTileState{};
+    std::vector<Point<int>> DueTiles;
+
+
+    TileProcess tileProcess(int tile)
+    {
+        if ((tile >= FLOOD) && (tile < RADTILE))
+        {
+            return floodActive() ? TileProcess::Flood : TileProcess::FloodReceding;
+        }
+        if ((tile >= RADTILE) && (tile < FIREBASE))
+        {
+            return TileProcess::Radiation;
+        }
+        if ((tile >= FIREBASE) && (tile < ROADBASE))
+        {
+            return TileProcess::Fire;
+        }
+        if ((tile >= SOMETINYEXP) && (tile <= LASTTINYEXP))
+        {
+            return TileProcess::Explosion;
+        }
+
+        return TileProcess::None;
+    }
+
+
+    TileProcess tileProcess(const Point<int>& location)
+    {
+        return tileProcess(maskedTileValue(location.x, location.y));
+    }
+
+
+    /**
+     * Cycles until the next change, drawn with the same odds a
+     * MapScan visit would have had on each cycle.
+     */
+    int cyclesUntilChange(TileProcess process)
+    {
+        switch (process)
+        {
+        case TileProcess::Fire:
+            return RandomTrials(4);
+
+        case TileProcess::FloodReceding:
+            return RandomTrials(16);
+
+        case TileProcess::Radiation:
+            return RandomTrials(4096);
+
+        default:
+            return 1;
+        }
+    }
+
+
+    void scheduleTile(const Point<int>& location, TileProcess process, int cycles)
+    {
+        auto& active = ActiveTileState[location.x][location.y];
+
+        active.process = process;
+        active.due = ActiveTiles.now() + cycles;
+
+        ActiveTiles.schedule(location, active.due);
+    }
+
+
+    /**
+     * Puts the tile MapScan is on onto the wheel unless it's already
+     * there for the same process. Its first roll is the one this
+     * visit would have made, on this cycle's tick.
+     */
+    void watchTile(const Point<int>& location)
+    {
+        const auto process = tileProcess(CurrentTileMasked);
+        if (ActiveTileState[location.x][location.y].process == process)
+        {
+            return;
+        }
+
+        deferSideEffect([location, process]()
+        {
+            scheduleTile(location, process, cyclesUntilChange(process));
+        });
+    }
+
+
+    bool scansBefore(const Point<int>& a, const Point<int>& b)
+    {
+        return (a.x < b.x) || ((a.x == b.x) && (a.y < b.y));
+    }
+
+
+    /**
+     * Runs the tiles that are due this cycle in MapScan order.
+     *
+     * Fire and flood spreading to a tile MapScan would still have
+     * reached this cycle get their first roll this cycle too, so they
+     * spread as fast as they did when found by the scan. Entries left
+     * behind by a tile that was rescheduled or has since changed are
+     * skipped.
+     */
+    void advanceActiveTiles()
+    {
+        ActiveTiles.advance(DueTiles);
+
+        const auto later = [](const Point<int>& a, const Point<int>& b) { return scansBefore(b, a); };
+        std::make_heap(DueTiles.begin(), DueTiles.end(), later);
+
+        while (!DueTiles.empty())
+        {
+            std::pop_heap(DueTiles.begin(), DueTiles.end(), later);
+            const auto location = DueTiles.back();
+            DueTiles.pop_back();
+
+            auto& active = ActiveTileState[location.x][location.y];
+            if ((active.process == TileProcess::None) || (active.due != ActiveTiles.now()))
+            {
+                continue;
+            }
+
+            const auto scheduled = active.process;
+            active.process = TileProcess::None;
+
+            const auto process = tileProcess(location);
+            if (process != scheduled)
+            {
+                if (process != TileProcess::None)
+                {
+                    scheduleTile(location, process, cyclesUntilChange(process));
+                }
+                continue;
+            }
+
+            SimulationTarget = location;
+
+            switch (process)
+            {
+            case TileProcess::Fire:
+                DoFire();
+                break;
+
+            case TileProcess::Flood:
+            case TileProcess::FloodReceding:
+                DoFlood();
+                break;
+
+            case TileProcess::Radiation:
+                DoRadTile();
+                break;
+
+            case TileProcess::Explosion: // clear AniRubble
+                Map[location.x][location.y] = RUBBLE + (Rand16() & 3) + BULLBIT;
+                break;
+
+            default:
+                break;
+            }
+
+            const auto next = tileProcess(location);
+            if (next != TileProcess::None)
+            {
+                scheduleTile(location, next, cyclesUntilChange(next));
+            }
+
+            forEachNeighbor(location, [&location, &later](const Point<int>& neighbor, int)
+            {
+                if (ActiveTileState[neighbor.x][neighbor.y].process != TileProcess::None)
+                {
+                    return;
+                }
+
+                const auto spread = tileProcess(neighbor);
+                if (spread == TileProcess::None)
+                {
+                    return;
+                }
+
+                const int cycles = cyclesUntilChange(spread);
+                if (!scansBefore(location, neighbor))
+                {
+                    scheduleTile(neighbor, spread, cycles);
+                    return;
+                }
+
+                if (cycles > 1)
+                {
+                    scheduleTile(neighbor, spread, cycles - 1);
+                    return;
+                }
+
+                ActiveTileState[neighbor.x][neighbor.y] = { spread, ActiveTiles.now() };
+                DueTiles.push_back(neighbor);
+                std::push_heap(DueTiles.begin(), DueTiles.end(), later);
+            });
+        }
+    }
+
+
+    void resetActiveTiles()
+    {
+        ActiveTiles.clear();
+        ActiveTileState = {};
+    }
+};
+
+
+/**
+ * Census counters, kept by the simulation thread.
+ */
+std::array<int*, CensusCounterCount> censusCounters()
+{
+    return
+    {
+        &PoweredZoneCount, &UnpoweredZoneCount, &FirePop, &RoadTotal, &RailTotal,
+        &ResPop, &ComPop, &IndPop, &ResZPop, &ComZPop, &IndZPop,
+        &HospPop, &ChurchPop, &StadiumPop, &PolicePop, &FireStPop,
+        &CoalPop, &NuclearPop, &PortPop, &APortPop
+    };
+}
+
+
+/**
+ * What the zone or column being scanned on the calling thread has
+ * counted so far, see \c recount().
+ */
+CensusCounts& censusTally()
+{
+    thread_local CensusCounts tally{};
+    return tally;
+}
+
+
+namespace
+{
+    constexpr auto MapScanStripCount = 8;
+
+    /**
+     * A column strip of a parallel MapScan. Strips are scanned in two
+     * colours, even strips then odd strips, so strips running at the
+     * same time are a full strip (15 columns) apart. Tile writes reach
+     * at most 5 columns outside of the strip being scanned (fire
+     * spreading into an airport) and 8x8 effect map cells are never
+     * shared by two strips of the same colour.
+     */
+    struct MapScanStrip
+    {
+        std::mt19937 random;
+        CensusCounts census{};
+        std::vector<std::function<void()>> deferredEffects;
+    };
+
+    thread_local MapScanStrip* ActiveStrip{ nullptr };
+
+
+    /**
+     * The census is kept up to date as MapScan goes rather than cleared
+     * and counted again every cycle. Each zone and each column of
+     * non-zone tiles remembers what it added the last time it was
+     * scanned and only the difference is applied, so the counters hold
+     * a full census at any point in the cycle.
+     */
+    std::array<CensusCounts, SimWidth> ColumnCensus{};
+
+
+    /**
+     * Counts a zone or column from zero with \c count and adds the
+     * difference from what it counted last time to \c change.
+     */
+    template <typename Count>
+    void recount(CensusCounts& counted, CensusCounts& change, Count count)
+    {
+        auto& tally = censusTally();
+        const CensusCounts saved = tally;
+        tally = {};
+
+        count();
+
+        for (size_t i = 0; i < tally.size(); ++i)
+        {
+            change[i] += tally[i] - counted[i];
+        }
+
+        counted = tally;
+        tally = saved;
+    }
+
+
+    /**
+     * Takes back what a zone no longer on the map last counted.
+     */
+    void dropCensus(CensusCounts& counted, CensusCounts& change)
+    {
+        for (size_t i = 0; i < counted.size(); ++i)
+        {
+            change[i] -= counted[i];
+        }
+
+        counted = {};
+    }
+
+
+    /**
+     * Adds \c change to the census counters, or to the strip being
+     * scanned on this thread to be merged once the scan is done.
+     */
+    void addCensus(const CensusCounts& change, int sign)
+    {
+        if (ActiveStrip)
+        {
+            for (size_t i = 0; i < change.size(); ++i)
+            {
+                ActiveStrip->census[i] += change[i] * sign;
+            }
+            return;
+        }
+
+        const auto counters = censusCounters();
+        for (size_t i = 0; i < counters.size(); ++i)
+        {
+            *counters[i] += change[i] * sign;
+        }
+    }
+
+
+    void resetCensus()
+    {
+        for (auto* counter : censusCounters())
+        {
+            *counter = 0;
+        }
+
+        ColumnCensus = {};
+    }
+
+
+    /**
+     * Adds up what every zone and column last counted.
+     */
+    CensusCounts recountCensus()
+    {
+        CensusCounts total{};
+
+        for (const auto& column : ColumnCensus)
+        {
+            for (size_t i = 0; i < total.size(); ++i)
+            {
+                total[i] += column[i];
+            }
+        }
+
+        for (size_t zone = 0; zone < Zones.size(); ++zone)
+        {
+            for (size_t i = 0; i < total.size(); ++i)
+            {
+                total[i] += Zones.census(zone)[i];
+            }
+        }
+
+        return total;
+    }
+
+
+#if !defined(NDEBUG)
+    /**
+     * Checks the running census against a recount.
+     */
+    void verifyCensus()
+    {
+        const auto total = recountCensus();
+
+        const auto counters = censusCounters();
+        for (size_t i = 0; i < counters.size(); ++i)
+        {
+            if (*counters[i] != total[i])
+            {
+                throw std::runtime_error("Census counter " + std::to_string(i) + " is " + std::to_string(*counters[i]) + ", recount gives " + std::to_string(total[i]));
+            }
+        }
+    }
+#endif
+};
+
+
 /* comefrom: Simulate DoSimInit */
 void MapScan(int x1, int x2, const CityProperties& properties)
 {
+    CensusCounts change{};
+
+    // Zones come from the registry, in the same order the scan reaches them
+    auto zone = Zones.firstInColumn(x1);
+
     for (int x = x1; x < x2; x++)
     {
-        for (int y = 0; y < SimHeight; y++)
+        recount(ColumnCensus[x], change, [&]()
         {
-            CurrentTile = Map[x][y];
-            if (CurrentTile != 0)
+            forEachTile({ x, 0 }, { x + 1, SimHeight }, [&](const Point<int>& location)
             {
-                CurrentTileMasked = CurrentTile & LOMASK;	// Mask off status bits
+                if ((zone < Zones.size()) && (Zones.location(zone) == location))
+                {
+                    const auto index = zone++;
+
+                    CurrentTile = Map[location.x][location.y];
+                    if (!Zones.removed(index) && (CurrentTile & ZONEBIT))
+                    {
+                        CurrentTileMasked = CurrentTile & LOMASK;
+                        SimulationTarget = location;
+                        recount(Zones.census(index), change, [&]()
+                        {
+                            updateZone(index, properties);
+                        });
+                        return;
+                    }
 
-                const int tile = maskedTileValue(x, y);
+                    dropCensus(Zones.census(index), change);
+                }
 
-                if (CurrentTileMasked >= FLOOD)
+                CurrentTile = Map[location.x][location.y];
+                if (CurrentTile != 0)
                 {
-                    SimulationTarget = { x, y };
+                    CurrentTileMasked = CurrentTile & LOMASK;	// Mask off status bits
 
-                    if (CurrentTileMasked < ROADBASE)
+                    const auto tileClass = tileProperties(CurrentTileMasked).tileClass;
+                    if (tileClass < TileClass::Flood)
                     {
-                        if (CurrentTileMasked >= FIREBASE)
-                        {
-                            FirePop++;
-                            if (!(Rand16() & 3)) // 1 in 4 times
-                            {
-                                DoFire();
-                            }
-                            continue;
-                        }
-                        if (CurrentTileMasked < RADTILE)
-                        {
-                            DoFlood();
-                        }
-                        else
-                        {
-                            DoRadTile();
-                        }
-                        continue;
+                        return;
                     }
 
-                    if (CurrentTile & CONDBIT)
-                    {
-                        setZonePower({ x, y });
-                    }
+                    SimulationTarget = location;
+
+                    switch (tileClass)
+                    {
+                    case TileClass::Fire:
+                        censusTally()[Census::Fires]++;
+                        watchTile(location);
+                        return;
+
+                    case TileClass::Flood:
+                    case TileClass::Radiation:
+                        watchTile(location);
+                        return;
+
+                    default:
+                        break;
+                    }
+
+                    if (CurrentTile & ZONEBIT) // removed from the registry, gone by the next cycle
+                    {
+                        return;
+                    }
+
+                    if (CurrentTile & CONDBIT)
+                    {
+                        setZonePower(location);
+                    }
+
+                    switch (tileClass)
+                    {
+                    case TileClass::Road:
+                        DoRoad();
+                        break;
+
+                    case TileClass::Rail:
+                        DoRail(location);
+                        break;
+
+                    case TileClass::Explosion:
+                        watchTile(location);
+                        break;
+
+                    default:
+                        break;
+                    }
+                }
+            });
+        });
+    }
+
+    addCensus(change, 1);
+}
+
+
+namespace
+{
+    /**
+     * Data read or written by the analysis passes of phases 11 - 15.
+     */
+    enum AnalysisData : TaskGraph::Resource
+    {
+        TileData,
+        PowerGridData,
+        MessageData,
+        RandomData,
+        ScanScratchData,
+        CityCenterData,
+        TerrainData,
+        PollutionData, // PollutionMap, PolluteAverage and the most polluted location
+        LandValueData, // LandValueMap and LVAverage
+        CrimeData, // CrimeMap, CrimeAverage and the highest crime location
+        PopulationDensityData,
+        ComRateData,
+        PoliceStationData,
+        PoliceProtectionData,
+        FireStationData,
+        FireProtectionData
+    };
+
+    bool ParallelSimulationRequested{ false };
+    bool ParallelSimulationEnabled{ false };
+
+    std::unique_ptr<ThreadPool> SimulationPool;
+    std::array<MapScanStrip, MapScanStripCount> MapScanStrips;
+    TileMap MapScanSnapshot;
+
+    void scanStrip(MapScanStrip& strip, int x1, int x2, const CityProperties& properties)
+    {
+        strip.census = {};
+
+        ActiveStrip = &strip;
+        UseRandomStream(&strip.random);
+
+        MapScan(x1, x2, properties);
+
+        UseRandomStream(nullptr);
+        ActiveStrip = nullptr;
+    }
+
+
+    ThreadPool& simulationPool()
+    {
+        if (!SimulationPool)
+        {
+            const auto threads = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, MapScanStripCount / 2);
+            SimulationPool = std::make_unique<ThreadPool>(threads);
+        }
+
+        return *SimulationPool;
+    }
+
+
+    /**
+     * Scans the whole map with the strips spread over a thread pool.
+     *
+     * Each strip gets its own random stream seeded in strip order and
+     * anything that touches state shared between strips is deferred
+     * and replayed on the calling thread in strip order, so results
+     * don't depend on the number of threads.
+     */
+    void ParallelMapScan(const CityProperties& properties)
+    {
+        for (auto& strip : MapScanStrips)
+        {
+            strip.random.seed(RandomStreamSeed());
+        }
+
+        for (int colour = 0; colour < 2; ++colour)
+        {
+            MapScanSnapshot = Map;
+            trafficMapSource(&MapScanSnapshot);
+
+            simulationPool().parallelFor(MapScanStripCount / 2, [&](size_t job)
+            {
+                const int index = static_cast<int>(job) * 2 + colour;
+                scanStrip(MapScanStrips[index], index * SimWidth / MapScanStripCount, (index + 1) * SimWidth / MapScanStripCount, properties);
+            });
+
+            trafficMapSource(nullptr);
+
+            for (int index = colour; index < MapScanStripCount; index += 2)
+            {
+                auto& strip = MapScanStrips[index];
+
+                addCensus(strip.census, 1);
+
+                for (auto& effect : strip.deferredEffects)
+                {
+                    effect();
+                }
+
+                strip.deferredEffects.clear();
+            }
+        }
+    }
+
+
+    /**
+     * Phases 1 - 8. Scans one strip per phase, a column at a time, or,
+     * in parallel mode, the whole map on the first phase.
+     */
+    ResumablePass MapScanPhase(int strip, const CityProperties& properties)
+    {
+        ResumablePass pass;
+
+        if (!ParallelSimulationEnabled)
+        {
+            const int firstColumn = strip * SimWidth / MapScanStripCount;
+            const int columnCount = (strip + 1) * SimWidth / MapScanStripCount - firstColumn;
+
+            pass.stage(columnCount, [firstColumn, &properties](int column)
+            {
+                MapScan(firstColumn + column, firstColumn + column + 1, properties);
+            });
+        }
+        else if (strip == 0)
+        {
+            ParallelMapScan(properties);
+        }
+
+        return pass;
+    }
+
+
+    /*
+     * Analysis passes for phases 11 - 15, in serial order.
+     */
+    void addPowerScan(TaskGraph& graph)
+    {
+        graph.addTask({ TileData }, { PowerGridData, MessageData }, [coalPlants = CoalPop, nuclearPlants = NuclearPop]()
+        {
+            powerScan(coalPlants, nuclearPlants);
+        });
+    }
+
+
+    void addPollutionScan(TaskGraph& graph)
+    {
+        graph.addTask({ TileData, CityCenterData, CrimeData },
+            { ScanScratchData, TerrainData, PollutionData, LandValueData, RandomData },
+            pollutionAndLandValueScan);
+    }
+
+
+    void addCrimeScan(TaskGraph& graph)
+    {
+        graph.addTask({ LandValueData, PopulationDensityData },
+            { PoliceStationData, PoliceProtectionData, CrimeData, RandomData },
+            crimeScan);
+    }
+
+
+    void addPopulationDensityScan(TaskGraph& graph)
+    {
+        graph.addTask({ TileData },
+            { ScanScratchData, PopulationDensityData, ComRateData, CityCenterData },
+            scanPopulationDensity);
+    }
+
+
+    void addFireAnalysis(TaskGraph& graph)
+    {
+        graph.addTask({}, { FireStationData, FireProtectionData }, fireAnalysis);
+    }
+};
+
+
+/**
+ * Runs \c effect now or, if called from a strip of a parallel
+ * MapScan, queues it to run once the strip is done.
+ */
+void deferSideEffect(const std::function<void()>& effect)
+{
+    if (ActiveStrip)
+    {
+        ActiveStrip->deferredEffects.push_back(effect);
+        return;
+    }
+
+    effect();
+}
 
-                    if ((CurrentTileMasked >= ROADBASE) && (CurrentTileMasked < POWERBASE))
-                    {
-                        DoRoad();
-                        continue;
-                    }
 
-                    if (CurrentTile & ZONEBIT) // process Zones
-                    {
-                        updateZone({ x, y }, properties);
-                        continue;
-                    }
+/**
+ * Spreads MapScan and the analysis passes over worker threads.
+ * Takes effect at the start of the next simulation cycle.
+ */
+void parallelSimulation(bool enabled)
+{
+    ParallelSimulationRequested = enabled;
+}
 
-                    if ((tile >= RAILBASE) && (tile < ResidentialBase))
-                    {
-                        DoRail({ x, y });
-                        continue;
-                    }
-                    if ((CurrentTileMasked >= SOMETINYEXP) && (CurrentTileMasked <= LASTTINYEXP)) // clear AniRubble
-                    {
-                        Map[x][y] = RUBBLE + (Rand16() & 3) + BULLBIT;
-                    }
-                }
-            }
-        }
-    }
+
+bool parallelSimulation()
+{
+    return ParallelSimulationRequested;
 }
 
 
@@ -872,28 +1504,12 @@ void SetValves(const CityProperties& properties, const Budget& budget)
 }
 
 
+/**
+ * Clears what MapScan gathers from scratch each cycle. The census
+ * counters themselves carry over, see \c recount().
+ */
 void ClearCensus()
 {
-    PoweredZoneCount = 0;
-    UnpoweredZoneCount = 0;
-    FirePop = 0;
-    RoadTotal = 0;
-    RailTotal = 0;
-    ResPop = 0;
-    ComPop = 0;
-    IndPop = 0;
-    ResZPop = 0;
-    ComZPop = 0;
-    IndZPop = 0;
-    HospPop = 0;
-    ChurchPop = 0;
-    PolicePop = 0;
-    FireStPop = 0;
-    StadiumPop = 0;
-    CoalPop = 0;
-    NuclearPop = 0;
-    PortPop = 0;
-    APortPop = 0;
     resetPowerStack(); // Reset before Mapscan
 
     FireStationMap.reset();
@@ -1009,36 +1625,33 @@ void CollectTax(const CityProperties& properties, Budget& budget)
 // ROG == Rate Of Growth
 void DecROGMem()
 {
-    for (int x = 0; x < EighthWorldWidth; x++)
+    RateOfGrowthMap.forEachCell([](const Point<int>& coord)
     {
-        for (int y = 0; y < EighthWorldHeight; y++)
+        int z = RateOfGrowthMap.value(coord);
+        if (z == 0)
         {
-            int z = RateOfGrowthMap.value({ x, y });
-            if (z == 0)
-            {
-                continue;
-            }
-            if (z > 0)
+            return;
+        }
+        if (z > 0)
+        {
+            const auto rogVal = RateOfGrowthMap.value(coord);
+            RateOfGrowthMap.value(coord) = rogVal - 1;
+            if (z > 200) // prevent overflow
             {
-                const auto rogVal = RateOfGrowthMap.value({ x, y });
-                RateOfGrowthMap.value({ x, y }) = rogVal - 1;
-                if (z > 200) // prevent overflow
-                {
-                    RateOfGrowthMap.value({ x, y }) = std::min(z, 200);
-                }
-                continue;
+                RateOfGrowthMap.value(coord) = std::min(z, 200);
             }
-            if (z < 0)
+            return;
+        }
+        if (z < 0)
+        {
+            const auto rogVal = RateOfGrowthMap.value(coord);
+            RateOfGrowthMap.value(coord) = rogVal + 1;
+            if (z < -200)
             {
-                const auto rogVal = RateOfGrowthMap.value({ x, y });
-                RateOfGrowthMap.value({ x, y }) = rogVal + 1;
-                if (z < -200)
-                {
-                    RateOfGrowthMap.value({ x, y }) = -200;
-                }
+                RateOfGrowthMap.value(coord) = -200;
             }
         }
-    }
+    });
 }
 
 
@@ -1086,46 +1699,40 @@ void InitSimMemory()
 
 void DoNilPower()
 {
-    for (int x = 0; x < SimWidth; x++)
+    forEachTile([](const Point<int>& location)
     {
-        for (int y = 0; y < SimHeight; y++)
+        int z = Map[location.x][location.y];
+        if (z & ZONEBIT)
         {
-            int z = Map[x][y];
-            if (z & ZONEBIT)
-            {
-                SimulationTarget = { x, y };
-                setZonePower({ x, y });
-            }
+            SimulationTarget = location;
+            setZonePower(location);
         }
-    }
+    });
 }
 
 
 /* tends to empty TrafficDensityMap   */
 void DecTrafficMem()
 {   
-    for (int x = 0; x < HalfWorldWidth; x++)
+    TrafficDensityMap.forEachCell([](const Point<int>& coord)
     {
-        for (int y = 0; y < HalfWorldHeight; y++)
+        int z = TrafficDensityMap.value(coord);
+        if (z != 0)
         {
-            int z = TrafficDensityMap.value({ x, y });
-            if (z != 0)
+            if (z > 24)
             {
-                if (z > 24)
+                if (z > 200)
                 {
-                    if (z > 200)
-                    {
-                        TrafficDensityMap.value({ x, y }) = z - 34;
-                    }
-                    else
-                    {
-                        TrafficDensityMap.value({ x, y }) = z - 24;
-                    }
+                    TrafficDensityMap.value(coord) = z - 34;
+                }
+                else
+                {
+                    TrafficDensityMap.value(coord) = z - 24;
                 }
-                else TrafficDensityMap.value({ x, y }) = 0;
             }
+            else TrafficDensityMap.value(coord) = 0;
         }
-    }
+    });
 }
 
 
@@ -1216,13 +1823,66 @@ namespace
     int CrimeScanFrequency[5] = { 1,  1,  8, 18, 28 };
     int PopulationDensityScanFrequency[5] = { 1,  1,  9, 19, 29 };
     int FireAnalysisFrequency[5] = { 1,  1, 10, 20, 30 };
+
+    /**
+     * Time a frame may spend on the current phase. A phase that takes
+     * longer picks up where it left off on the next frame and the next
+     * phase waits for it, so the month and census cadence stay the same
+     * in simulation cycles. Zero means no limit.
+     */
+    TimeSlice::Clock::duration FrameTimeBudget{ std::chrono::milliseconds(8) };
+
+    // Frames that did simulation work, journal entries are stamped with it.
+    std::uint32_t SimulationFrame{ 0 };
+
+    ResumablePass CurrentPhase;
+    bool PhaseInProgress{ false };
+
+
+    /**
+     * Parallel mode runs every analysis pass that's due this cycle
+     * on phase 11, overlapping the ones that don't depend on each other.
+     */
+    void runAnalysis(int speed)
+    {
+        TaskGraph analysis;
+
+        if (!(Scycle % PowerScanFrequency[speed]))
+        {
+            addPowerScan(analysis);
+        }
+        if (!(Scycle % PollutionScanFrequency[speed]))
+        {
+            addPollutionScan(analysis);
+        }
+        if (!(Scycle % CrimeScanFrequency[speed]))
+        {
+            addCrimeScan(analysis);
+        }
+        if (!(Scycle % PopulationDensityScanFrequency[speed]))
+        {
+            addPopulationDensityScan(analysis);
+        }
+        if (!(Scycle % FireAnalysisFrequency[speed]))
+        {
+            addFireAnalysis(analysis);
+        }
+
+        analysis.run(simulationPool());
+    }
 };
 
 
+/**
+ * Starts phase \c mod16. Work that can be split up is left in
+ * \c CurrentPhase for \c SimFrame to run within the frame budget.
+ */
 void Simulate(int mod16, CityProperties& properties, Budget& budget)
 {
     int speed = static_cast<int>(SimSpeed()); // ew, find a better way to do this
 
+    CurrentPhase = {};
+
     switch (mod16)
     {
     case 0:
@@ -1243,41 +1903,46 @@ void Simulate(int mod16, CityProperties& properties, Budget& budget)
         }
         
         ClearCensus();
+        addCensus(Zones.compact(Map), -1);
+        ParallelSimulationEnabled = ParallelSimulationRequested;
         break;
 
     case 1:
-        MapScan(0, 1 * SimWidth / 8, properties);
+        CurrentPhase = MapScanPhase(0, properties);
         break;
 
     case 2:
-        MapScan(1 * SimWidth / 8, 2 * SimWidth / 8, properties);
+        CurrentPhase = MapScanPhase(1, properties);
         break;
 
     case 3:
-        MapScan(2 * SimWidth / 8, 3 * SimWidth / 8, properties);
+        CurrentPhase = MapScanPhase(2, properties);
         break;
 
     case 4:
-        MapScan(3 * SimWidth / 8, 4 * SimWidth / 8, properties);
+        CurrentPhase = MapScanPhase(3, properties);
         break;
 
     case 5:
-        MapScan(4 * SimWidth / 8, 5 * SimWidth / 8, properties);
+        CurrentPhase = MapScanPhase(4, properties);
         break;
 
     case 6:
-        MapScan(5 * SimWidth / 8, 6 * SimWidth / 8, properties);
+        CurrentPhase = MapScanPhase(5, properties);
         break;
 
     case 7:
-        MapScan(6 * SimWidth / 8, 7 * SimWidth / 8, properties);
+        CurrentPhase = MapScanPhase(6, properties);
         break;
 
     case 8:
-        MapScan(7 * SimWidth / 8, SimWidth, properties);
+        CurrentPhase = MapScanPhase(7, properties);
         break;
 
     case 9:
+#if !defined(NDEBUG)
+        verifyCensus();
+#endif
         if (!(CityTime % CensusRate))
         {
             TakeCensus(budget);
@@ -1300,43 +1965,48 @@ void Simulate(int mod16, CityProperties& properties, Budget& budget)
             DecROGMem();
         }
         DecTrafficMem();
+        advanceActiveTiles();
         SendMessages(budget);
         break;
 
     case 11:
-        if (!(Scycle % PowerScanFrequency[speed]))
+        if (ParallelSimulationEnabled)
         {
-            powerScan();
+            runAnalysis(speed);
+        }
+        else if (!(Scycle % PowerScanFrequency[speed]))
+        {
+            CurrentPhase = powerScanPass();
         }
         break;
 
     case 12:
-        if (!(Scycle % PollutionScanFrequency[speed]))
+        if (!ParallelSimulationEnabled && !(Scycle % PollutionScanFrequency[speed]))
         {
-            pollutionAndLandValueScan();
+            CurrentPhase = pollutionAndLandValuePass();
         }
         break;
 
     case 13:
-        if (!(Scycle % CrimeScanFrequency[speed]))
+        if (!ParallelSimulationEnabled && !(Scycle % CrimeScanFrequency[speed]))
         {
-            crimeScan();
+            CurrentPhase = crimeScanPass();
         }
         break;
 
     case 14:
-        if (!(Scycle % PopulationDensityScanFrequency[speed]))
+        if (!ParallelSimulationEnabled && !(Scycle % PopulationDensityScanFrequency[speed]))
         {
-            scanPopulationDensity();
+            CurrentPhase = populationDensityPass();
         }
         break;
 
     case 15:
-        if (!(Scycle % FireAnalysisFrequency[speed]))
+        if (!ParallelSimulationEnabled && !(Scycle % FireAnalysisFrequency[speed]))
         {
-            fireAnalysis();
+            CurrentPhase = fireAnalysisPass();
         }
-        DoDisasters(properties);
+        CurrentPhase.stage([&properties]() { DoDisasters(properties); });
         break;
     }
 }
@@ -1349,12 +2019,43 @@ void SimFrame(CityProperties& properties, Budget& budget)
         return;
     }
 
-    if (++Fcycle > 1024)
+    if (!PhaseInProgress)
     {
-        Fcycle = 0;
+        if (++Fcycle > 1024)
+        {
+            Fcycle = 0;
+        }
+
+        Simulate(Fcycle % 16, properties, budget);
     }
 
-    Simulate(Fcycle % 16, properties, budget);
+    const bool limited = FrameTimeBudget > TimeSlice::Clock::duration::zero();
+    PhaseInProgress = !CurrentPhase.run(limited ? TimeSlice{ FrameTimeBudget } : TimeSlice{});
+
+    ++SimulationFrame;
+}
+
+
+std::uint32_t simulationFrame()
+{
+    return SimulationFrame;
+}
+
+
+/**
+ * Sets how long a frame may spend on simulation work. With a budget
+ * of zero every phase finishes in the frame it starts in, which makes
+ * a run independent of how fast the machine is.
+ */
+void simulationFrameBudget(std::chrono::microseconds budget)
+{
+    FrameTimeBudget = budget;
+}
+
+
+std::chrono::microseconds simulationFrameBudget()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(FrameTimeBudget);
 }
 
 
@@ -1363,6 +2064,13 @@ void DoSimInit(CityProperties& properties, Budget& budget)
     Fcycle = 0;
     Scycle = 0;
 
+    CurrentPhase = {};
+    PhaseInProgress = false;
+
+    resetActiveTiles();
+    resetPollutionScan();
+    Zones.rebuild(Map);
+
     if (InitSimLoad == 2) 			/* if new city    */
     {
         InitSimMemory();
@@ -1375,18 +2083,319 @@ void DoSimInit(CityProperties& properties, Budget& budget)
 
     SetValves(properties, budget);
     ClearCensus();
-    MapScan(0, SimWidth, properties); /* XXX are you sure ??? */
-    powerScan();
-    pollutionAndLandValueScan();
-    crimeScan();
-    scanPopulationDensity();
-    fireAnalysis();
+    resetCensus();
+
+    ParallelSimulationEnabled = ParallelSimulationRequested;
+    if (ParallelSimulationEnabled)
+    {
+        ParallelMapScan(properties);
+
+        TaskGraph analysis;
+        addPowerScan(analysis);
+        addPollutionScan(analysis);
+        addCrimeScan(analysis);
+        addPopulationDensityScan(analysis);
+        addFireAnalysis(analysis);
+        analysis.run(simulationPool());
+    }
+    else
+    {
+        MapScan(0, SimWidth, properties); /* XXX are you sure ??? */
+        powerScan();
+        pollutionAndLandValueScan();
+        crimeScan();
+        scanPopulationDensity();
+        fireAnalysis();
+    }
+    newMap(true);
+    TotalPop = 1;
+    DoInitialEval = 1;
+}
+
+
+namespace
+{
+    /**
+     * Effect maps kept in a SimulationState, in that order.
+     */
+    const std::array<EffectMap*, 12> SimulationEffectMaps
+    {
+        &PopulationDensityMap, &TrafficDensityMap, &PollutionMap, &LandValueMap,
+        &CrimeMap, &TerrainMem, &RateOfGrowthMap, &FireStationMap,
+        &PoliceStationMap, &PoliceProtectionMap, &FireProtectionMap, &ComRate
+    };
+
+
+    /**
+     * Histories kept in a SimulationClone, in that order.
+     */
+    const std::array<GraphHistory*, 14> ClonedHistories
+    {
+        &ResHis, &ComHis, &IndHis, &MoneyHis, &PollutionHis, &CrimeHis, &MiscHis,
+        &ResHis120Years, &ComHis120Years, &IndHis120Years, &MoneyHis120Years,
+        &PollutionHis120Years, &CrimeHis120Years, &MiscHis120Years
+    };
+
+
+    /**
+     * Loose globals kept in a SimulationClone, in that order. Census
+     * counters aren't here, they're counted again from the zones.
+     */
+    const std::array<int*, 36> ClonedValues
+    {
+        &TotalPop, &LastTotalPop, &TotalZPop, &NeedHosp, &NeedChurch,
+        &CrimeAverage, &PolluteAverage, &LVAverage, &CityTime, &StartingYear,
+        &ResHisMax, &ComHisMax, &IndHisMax, &RoadEffect, &PoliceEffect, &FireEffect,
+        &CrimeRamp, &PolluteRamp, &ResCap, &ComCap, &IndCap,
+        &DisasterEvent, &DisasterWait, &ScoreType, &ScoreWait, &AvCityTax,
+        &DoInitialEval, &MeltX, &MeltY, &ShakeNow, &FloodCount, &FloodX, &FloodY,
+        &ScenarioID, &InitSimLoad, &Cycle
+    };
+
+    static_assert(std::tuple_size<decltype(SimulationClone::histories)>::value == ClonedHistories.size());
+    static_assert(std::tuple_size<decltype(SimulationClone::values)>::value == ClonedValues.size());
+
+
+    /**
+     * Puts back what \c captureSimulationState() copied.
+     */
+    void applySimulationState(const SimulationState& state)
+    {
+        Fcycle = state.fcycle;
+        Scycle = state.scycle;
+
+        RValve = state.rValve;
+        CValve = state.cValve;
+        IValve = state.iValve;
+
+        Zones = state.zones;
+        ColumnCensus = state.columnCensus;
+
+        const auto counters = censusCounters();
+        const auto census = recountCensus();
+        for (std::size_t i = 0; i < counters.size(); ++i)
+        {
+            *counters[i] = census[i];
+        }
+
+        powerMap(state.powerMap);
+        powerStack(state.powerStack);
+
+        cityCenterOfMass(state.cityCenter);
+        pollutionMax(state.pollutionMax);
+
+        for (std::size_t i = 0; i < SimulationEffectMaps.size(); ++i)
+        {
+            *SimulationEffectMaps[i] = state.effectMaps[i];
+        }
+    }
+};
+
+
+/**
+ * Copies the state a warm start needs. Returns false while a phase
+ * is part way through as its results would only be half there.
+ */
+bool captureSimulationState(SimulationState& state)
+{
+    if (PhaseInProgress)
+    {
+        return false;
+    }
+
+    state.scycle = Scycle;
+    state.fcycle = Fcycle;
+
+    state.rValve = RValve;
+    state.cValve = CValve;
+    state.iValve = IValve;
+
+    state.zones = Zones;
+    state.columnCensus = ColumnCensus;
+
+    state.powerMap = powerMap();
+    state.powerStack = powerStack();
+
+    state.cityCenter = cityCenterOfMass();
+    state.pollutionMax = pollutionMax();
+
+    if (state.effectMaps.size() != SimulationEffectMaps.size())
+    {
+        state.effectMaps.clear();
+        for (const auto* map : SimulationEffectMaps)
+        {
+            state.effectMaps.push_back(*map);
+        }
+    }
+    else
+    {
+        for (std::size_t i = 0; i < SimulationEffectMaps.size(); ++i)
+        {
+            state.effectMaps[i] = *SimulationEffectMaps[i];
+        }
+    }
+
+    return true;
+}
+
+
+/**
+ * Checks a loaded SimulationState has every effect map at the size
+ * this build uses.
+ */
+bool simulationStateFits(const SimulationState& state)
+{
+    if (state.effectMaps.size() != SimulationEffectMaps.size())
+    {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < SimulationEffectMaps.size(); ++i)
+    {
+        if (state.effectMaps[i].dimensions() != SimulationEffectMaps[i]->dimensions())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/**
+ * Picks up a loaded city from a saved SimulationState instead of
+ * scanning the map. MapScan starts watching burning and flooded
+ * tiles again as it reaches them.
+ */
+void DoSimInit(CityProperties& properties, const SimulationState& state)
+{
+    if (!simulationStateFits(state))
+    {
+        throw std::runtime_error("DoSimInit(): Saved simulation state doesn't fit this simulation.");
+    }
+
+    CurrentPhase = {};
+    PhaseInProgress = false;
+
+    resetActiveTiles();
+    resetPollutionScan();
+
+    if (InitSimLoad == 1)
+    {
+        SimLoadInit(properties);
+    }
+
+    applySimulationState(state);
+
+    ParallelSimulationEnabled = ParallelSimulationRequested;
+
     newMap(true);
     TotalPop = 1;
     DoInitialEval = 1;
 }
 
 
+/**
+ * Copies the whole running simulation into \c clone. Returns false
+ * while a phase is part way through, try again after the next frame.
+ */
+bool cloneSimulation(SimulationClone& clone, const CityProperties& properties, const Budget& budget)
+{
+    if (!captureSimulationState(clone.state))
+    {
+        return false;
+    }
+
+    capturePollutionScan(clone.pollutionScan);
+
+    clone.map = Map;
+
+    for (std::size_t i = 0; i < ClonedHistories.size(); ++i)
+    {
+        clone.histories[i] = *ClonedHistories[i];
+    }
+
+    for (std::size_t i = 0; i < ClonedValues.size(); ++i)
+    {
+        clone.values[i] = *ClonedValues[i];
+    }
+
+    clone.eMarket = EMarket;
+
+    clone.activeTiles = ActiveTiles;
+    clone.activeTileState = ActiveTileState;
+
+    clone.sprites = sprites();
+    clone.crashPosition = crashPosition();
+
+    clone.evaluation = evaluationState();
+
+    clone.budget = budget;
+    clone.properties = properties;
+
+    clone.speed = SimSpeed();
+    clone.autoBudget = autoBudget();
+    clone.autoBulldoze = AutoBulldoze;
+    clone.noDisasters = NoDisasters;
+
+    clone.random = RandomState();
+    clone.frame = SimulationFrame;
+
+    return true;
+}
+
+
+/**
+ * Makes \c clone the running simulation. It carries on exactly as
+ * the simulation it was cloned from would have.
+ */
+void restoreSimulation(const SimulationClone& clone, CityProperties& properties, Budget& budget)
+{
+    CurrentPhase = {};
+    PhaseInProgress = false;
+
+    Map = clone.map;
+
+    for (std::size_t i = 0; i < ClonedHistories.size(); ++i)
+    {
+        *ClonedHistories[i] = clone.histories[i];
+    }
+
+    for (std::size_t i = 0; i < ClonedValues.size(); ++i)
+    {
+        *ClonedValues[i] = clone.values[i];
+    }
+
+    EMarket = clone.eMarket;
+
+    applySimulationState(clone.state);
+    applyPollutionScan(clone.pollutionScan);
+
+    ActiveTiles = clone.activeTiles;
+    ActiveTileState = clone.activeTileState;
+
+    sprites(clone.sprites);
+    crashPosition(clone.crashPosition);
+
+    evaluationState(clone.evaluation);
+
+    budget = clone.budget;
+    properties = clone.properties;
+
+    if (SimSpeed() != clone.speed)
+    {
+        SimSpeed(clone.speed);
+    }
+
+    autoBudget(clone.autoBudget);
+    AutoBulldoze = clone.autoBulldoze;
+    NoDisasters = clone.noDisasters;
+
+    RandomState(clone.random);
+    SimulationFrame = clone.frame;
+}
+
+
 void UpdateFundEffects(const Budget& budget)
 {
     if (budget.RoadFundsNeeded())
@@ -1420,9 +2429,10 @@ void UpdateFundEffects(const Budget& budget)
 
 void FireZone(int Xloc, int Yloc, int ch)
 {
-    int Xtem, Ytem;
     int XYmax;
 
+    Zones.remove({ Xloc, Yloc });
+
     const auto rogVal = RateOfGrowthMap.value({ Xloc / 8, Yloc / 8 });
     RateOfGrowthMap.value({ Xloc / 8, Yloc / 8 }) = rogVal - 20;
 
@@ -1443,21 +2453,16 @@ void FireZone(int Xloc, int Yloc, int ch)
         }
     }
 
-    for (int x = -1; x < XYmax; x++)
+    forEachTile({ Xloc - 1, Yloc - 1 }, { Xloc + XYmax, Yloc + XYmax }, [](const Point<int>& location)
     {
-        for (int y = -1; y < XYmax; y++)
+        if (!CoordinatesValid(location))
         {
-            Xtem = Xloc + x;
-            Ytem = Yloc + y;
-            if ((Xtem < 0) || (Xtem > (SimWidth - 1)) || (Ytem < 0) || (Ytem > (SimHeight - 1)))
-            {
-                continue;
-            }
+            return;
+        }
 
-            if ((int)(Map[Xtem][Ytem] & LOMASK) >= ROADBASE) // post release
-            {
-                Map[Xtem][Ytem] |= BULLBIT;
-            }
+        if ((int)(Map[location.x][location.y] & LOMASK) >= ROADBASE) // post release
+        {
+            Map[location.x][location.y] |= BULLBIT;
         }
-    }
+    });
 }
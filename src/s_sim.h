@@ -10,11 +10,140 @@
 // file, included in this distribution, for details.
 #pragma once
 
-class Budget;
-class CityProperties;
+#include "Budget.h"
+#include "Census.h"
+#include "CityProperties.h"
+#include "EffectMap.h"
+#include "Evaluation.h"
+#include "Map.h"
+#include "Point.h"
+#include "Power.h"
+#include "Scan.h"
+#include "Sprite.h"
+#include "TimingWheel.h"
+#include "ZoneRegistry.h"
+
+#include "s_alloc.h"
+#include "w_util.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+
+/**
+ * Short lived tiles that change state at random. Rather than
+ * rolling for each of them on every visit, the wait until the next
+ * change is drawn up front and the tile is put on a timing wheel
+ * that ticks once per simulation cycle.
+ */
+enum class TileProcess : char
+{
+	None,
+	Fire,
+	Flood,
+	FloodReceding,
+	Radiation,
+	Explosion
+};
+
+struct ActiveTile
+{
+	TileProcess process{ TileProcess::None };
+	TimingWheel::Time due{};
+};
+
+using ActiveTileMap = std::array<std::array<ActiveTile, SimHeight>, SimWidth>;
+
+
+/**
+ * What DoSimInit() would otherwise work out by scanning the whole
+ * map, kept with a save so loading it can skip straight to play.
+ */
+struct SimulationState
+{
+	int scycle{};
+	int fcycle{};
+
+	int rValve{};
+	int cValve{};
+	int iValve{};
+
+	ZoneRegistry zones{};
+	std::array<CensusCounts, SimWidth> columnCensus{};
+
+	PowerMapWords powerMap{};
+	std::vector<Point<int>> powerStack{};
+
+	Point<int> cityCenter{};
+	Point<int> pollutionMax{};
+
+	std::vector<EffectMap> effectMaps{};
+};
+
+bool captureSimulationState(SimulationState&);
+bool simulationStateFits(const SimulationState&);
+
+
+/**
+ * A copy of everything the running simulation holds in its globals,
+ * so the city being played can be put aside and put back exactly as
+ * it was.
+ *
+ * A clone isn't a simulation of its own. The simulation only runs on
+ * the globals, so a clone is run by restoring it over them, one at a
+ * time on the simulation thread. Besides fixed size arrays it holds
+ * vectors: the effect maps, the zone registry, the power stack and
+ * the sprites, so cloning and restoring allocate.
+ */
+struct SimulationClone
+{
+	TileMap map{};
+	std::array<GraphHistory, 14> histories{};
+	std::array<int, 36> values{}; // loose globals, in ClonedValues order
+	float eMarket{};
+
+	SimulationState state{};
+	PollutionScanCache pollutionScan{};
+
+	TimingWheel activeTiles{};
+	ActiveTileMap activeTileState{};
+
+	std::vector<SimSprite> sprites{};
+	Point<int> crashPosition{};
+
+	EvaluationState evaluation{};
+
+	Budget budget{};
+	CityProperties properties{};
+
+	SimulationSpeed speed{};
+	bool autoBudget{};
+	bool autoBulldoze{};
+	bool noDisasters{};
+
+	std::mt19937 random{};
+	std::uint32_t frame{};
+};
+
+bool cloneSimulation(SimulationClone&, const CityProperties&, const Budget&);
+void restoreSimulation(const SimulationClone&, CityProperties&, Budget&);
 
 void SimFrame(CityProperties&, Budget&);
+std::uint32_t simulationFrame();
 void FireZone(int Xloc, int Yloc, int ch);
 void DoSimInit(CityProperties&, Budget&);
+void DoSimInit(CityProperties&, const SimulationState&);
 void DoSPZone(bool powered, const CityProperties&);
 void RepairZone(int ZCent, int zsize);
+
+void parallelSimulation(bool enabled);
+bool parallelSimulation();
+
+void simulationFrameBudget(std::chrono::microseconds budget);
+std::chrono::microseconds simulationFrameBudget();
+
+void deferSideEffect(const std::function<void()>& effect);
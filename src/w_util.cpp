@@ -200,14 +200,82 @@ void DoPopUpMessage(char *msg)
 }
 
 
-static std::random_device RandomDevice;
-static std::mt19937 PseudoRandomNumberGenerator(RandomDevice());
+static std::mt19937 PseudoRandomNumberGenerator;
+static std::mt19937::result_type LastRandomSeed{ std::mt19937::default_seed };
+
+/**
+ * Generator used by the calling thread. Null means the shared
+ * generator above, which must not be used by two threads at once.
+ */
+static thread_local std::mt19937* ActiveRandomStream{ nullptr };
+
+
+static std::mt19937& ActiveGenerator()
+{
+    return ActiveRandomStream ? *ActiveRandomStream : PseudoRandomNumberGenerator;
+}
+
+
+/**
+ * Restarts the shared generator from \c seed. The simulation draws
+ * every random number from it, so the same seed and the same
+ * commands give the same city.
+ */
+void SeedRandom(std::mt19937::result_type seed)
+{
+    PseudoRandomNumberGenerator.seed(seed);
+    LastRandomSeed = seed;
+}
+
+
+/**
+ * Seed the shared generator was last started from.
+ */
+std::mt19937::result_type RandomSeed()
+{
+    return LastRandomSeed;
+}
+
+
+const std::mt19937& RandomState()
+{
+    return PseudoRandomNumberGenerator;
+}
+
+
+/**
+ * Puts the shared generator back the way it was when
+ * \c RandomState() was copied.
+ */
+void RandomState(const std::mt19937& state)
+{
+    PseudoRandomNumberGenerator = state;
+}
+
+
+/**
+ * Redirects RandomRange(), Random() and Rand16() on the calling
+ * thread to \c stream. Pass nullptr to go back to the shared generator.
+ */
+void UseRandomStream(std::mt19937* stream)
+{
+    ActiveRandomStream = stream;
+}
+
+
+/**
+ * Draws a seed for a private random stream from the shared generator.
+ */
+std::mt19937::result_type RandomStreamSeed()
+{
+    return PseudoRandomNumberGenerator();
+}
 
 
 int RandomRange(int min, int max)
 {
     std::uniform_int_distribution<std::mt19937::result_type> prngDistribution(min, max);
-    return prngDistribution(PseudoRandomNumberGenerator);
+    return prngDistribution(ActiveGenerator());
 }
 
 
@@ -221,3 +289,19 @@ int Rand16()
 {
     return RandomRange(0, 32767) * (RandomRange(0, 1) ? -1 : 1);
 }
+
+
+/**
+ * Number of tries it takes for something with a 1 in \c oneIn chance
+ * to happen, counting the try it happens on.
+ */
+int RandomTrials(int oneIn)
+{
+    if (oneIn <= 1)
+    {
+        return 1;
+    }
+
+    std::geometric_distribution<int> distribution(1.0 / oneIn);
+    return distribution(ActiveGenerator()) + 1;
+}
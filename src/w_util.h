@@ -13,6 +13,7 @@
 #include "Point.h"
 
 #include <SDL2/SDL.h>
+#include <random>
 #include <string>
 
 class Budget;
@@ -48,6 +49,15 @@ Point<int> PositionToCell(const Point<int>& position, const Point<int>& offset);
 const Vector<int> vectorFromPoints(const Point<int>& start, const Point<int>& end);
 bool pointInRect(const Point<int>& point, const SDL_Rect& rect);
 
+void SeedRandom(std::mt19937::result_type seed);
+std::mt19937::result_type RandomSeed();
+const std::mt19937& RandomState();
+void RandomState(const std::mt19937& state);
+
+void UseRandomStream(std::mt19937* stream);
+std::mt19937::result_type RandomStreamSeed();
+
 int RandomRange(int min, int max);
 int Random();
 int Rand16();
+int RandomTrials(int oneIn);